@@ -5,7 +5,6 @@
 
 
 #include "PITimer.h"
-#include <mk20dx128.h>
 #include <stdint.h>
 #include <math.h>
 
@@ -14,7 +13,10 @@
 // ------------------------------------------------------------
 // these are the pre-defined timer objects corresponding
 // to the 4 internal Periodic Interrupt Timers (PITs).
-// PIT3 is disabled because it conflicts with tone()
+// PIT3 is disabled because it conflicts with tone().
+// their constructor is constexpr, so they're set up by the
+// compiler rather than at startup, and left out of the image if
+// the sketch doesn't use them
 // ------------------------------------------------------------
 PITimer PITimer0(0);
 PITimer PITimer1(1);
@@ -28,243 +30,164 @@ PITimer PITimer2(2);
 // that get called by each timer when it fires.
 // they're defined here a) so that they can auto-clear
 // themselves and b) so the user can specify a custom
-// ISR of their own, and even reassign it as needed
+// ISR of their own, and even reassign it as needed.
+// each one jumps to the handler its channel installed when it
+// was started, rather than calling it directly. the vector table
+// always refers to these, so a direct call would keep every
+// channel's ISR in the image, used or not. this way, a channel
+// that's never started costs no flash. there's nothing to jump
+// to before then, but the interrupt can't fire before then either.
+// the sampler's channel gets its ISR from PITimerSampler.cpp
 // ------------------------------------------------------------
-void pit0_isr() { PITimer0.clear(); PITimer0.myISR(); }
-void pit1_isr() { PITimer1.clear(); PITimer1.myISR(); }
-void pit2_isr() { PITimer2.clear(); PITimer2.myISR(); }
-//void pit3_isr() { PITimer3.clear(); PITimer3.myISR(); }
-
-
-
-// ------------------------------------------------------------
-// the actual period of a timer is stored as a quantity
-// of bus clock cycles, and that's what "value" represents.
-// all this function does is perform the register write.
-// it needs to be called whenever myValue is changed
-// ------------------------------------------------------------
-void PITimer::writeValue() {
-  *PIT_LDVAL = myValue;
-}
+#if !PITIMER_SAMPLER || PITIMER_SAMPLER_CHANNEL != 0
+void pit0_isr() { PITimerBase::dispatch(0); }
+#endif
+#if !PITIMER_SAMPLER || PITIMER_SAMPLER_CHANNEL != 1
+void pit1_isr() { PITimerBase::dispatch(1); }
+#endif
+#if !PITIMER_SAMPLER || PITIMER_SAMPLER_CHANNEL != 2
+void pit2_isr() { PITimerBase::dispatch(2); }
+#endif
+//void pit3_isr() { PITimerBase::dispatch(3); }
 
 
 
 // ------------------------------------------------------------
 // very simply rounds a float to its nearest integer value
 // ------------------------------------------------------------
-float PITimer::roundFloat(float value) {
+float PITimerBase::roundFloat(float value) {
   return floor(value + 0.5);
 }
 
 
 
 // ------------------------------------------------------------
-// initializer for the PITimer class, mostly used to set defaults
-// and to forward our generic pointers to a specific set of regs.
-// F_BUS is equal to the frequency of the bus clock. we're also
-// enabling the overall clock access to the PIT module, both via the
-// SIM (System Integration Module) and the PIT's own MCR (Module
-// Control Register). enabling these global controls for each timer
-// isn't necessary, but it doesn't do any harm either.
-// ------------------------------------------------------------
-PITimer::PITimer(uint8_t timerID) : myID(timerID), isRunning(false) {
-  
-       if (myID == 0) PIT_LDVAL = &PIT_LDVAL0;
-  else if (myID == 1) PIT_LDVAL = &PIT_LDVAL1;
-  else if (myID == 2) PIT_LDVAL = &PIT_LDVAL2;
-  else if (myID == 3) PIT_LDVAL = &PIT_LDVAL3;
-  
-       if (myID == 0) PIT_TCTRL = &PIT_TCTRL0;
-  else if (myID == 1) PIT_TCTRL = &PIT_TCTRL1;
-  else if (myID == 2) PIT_TCTRL = &PIT_TCTRL2;
-  else if (myID == 3) PIT_TCTRL = &PIT_TCTRL3;
-  
-       if (myID == 0) PIT_TFLG = &PIT_TFLG0;
-  else if (myID == 1) PIT_TFLG = &PIT_TFLG1;
-  else if (myID == 2) PIT_TFLG = &PIT_TFLG2;
-  else if (myID == 3) PIT_TFLG = &PIT_TFLG3;
-  
-       if (myID == 0) PIT_CVAL = &PIT_CVAL0;
-  else if (myID == 1) PIT_CVAL = &PIT_CVAL1;
-  else if (myID == 2) PIT_CVAL = &PIT_CVAL2;
-  else if (myID == 3) PIT_CVAL = &PIT_CVAL3;
-  
-       if (myID == 0) IRQ_PIT_CH = IRQ_PIT_CH0;
-  else if (myID == 1) IRQ_PIT_CH = IRQ_PIT_CH1;
-  else if (myID == 2) IRQ_PIT_CH = IRQ_PIT_CH2;
-  else if (myID == 3) IRQ_PIT_CH = IRQ_PIT_CH3;
-
-  SIM_SCGC6 |= SIM_SCGC6_PIT;
-  PIT_MCR = 0;
-  value(F_BUS);
-  
-}
-
-
-
-// ------------------------------------------------------------
-// this version of value() (with an argument) is used to set the
-// timer value directly, either by the user, or by one of the other
-// (more useful) set functions. only useful externally if the timer
-// needs to perform some kind of bus-clock-specific function.
-// includes some basic range validation. timer behavior seems to
-// become unstable at very low values or at 2^32-1 (UINT32_MAX)
-// ------------------------------------------------------------
-void PITimer::value(uint32_t newValue) {
-  if (newValue == UINT32_MAX) newValue = UINT32_MAX - 1;
-  else if (newValue < valueMin) newValue = valueMin;
-  myValue = newValue;
-  writeValue();
-}
-
-
-
-// ------------------------------------------------------------
-// this version of period() (with an argument) is used to set the
-// period of the timer in terms of units of time (seconds).
-// for 48 MHz bus, range is about 14 ns (0.000014) to 89 s (89.0)
-// ------------------------------------------------------------
-void PITimer::period(float newPeriod) {
-  uint32_t newValue = roundFloat(F_BUS * newPeriod) - 1;
-  value(newValue);
-}
-
-
-
-// ------------------------------------------------------------
-// this version of frequency() (with an argument) is used to set the
-// frequency of the timer in terms of hertz (1 cycle per second).
-// for 48 MHz bus, range is about 12 mHz (0.012) to 75 kHz (75000)
-// ------------------------------------------------------------
-void PITimer::frequency(float newFrequency) {
-  uint32_t newValue = roundFloat(F_BUS / newFrequency) - 1;
-  value(newValue);
-}
-
-
-
-// ------------------------------------------------------------
-// get the current value of the timer (in bus clock cycles)
-// ------------------------------------------------------------
-uint32_t PITimer::value() {
-  return myValue;
-}
-
-
-
-// ------------------------------------------------------------
-// get the current period of the timer (in seconds)
-// ------------------------------------------------------------
-float PITimer::period() {
-  return (value() + 1) / float(F_BUS);
-}
-
-
-
-// ------------------------------------------------------------
-// get the current frequency of the timer (in hertz)
-// ------------------------------------------------------------
-float PITimer::frequency() {
-  return float(F_BUS) / (value() + 1);
-}
-
-
-
-// ------------------------------------------------------------
-// this function initializes and starts the timer, using the specified
-// function as a callback. must be passed the name of a function taking
-// no arguments and returning void. make sure this function can
-// complete within the time allowed (aka less than its period)
-// ------------------------------------------------------------
-void PITimer::start(void (*newISR)()) {
-  myISR = newISR;
-  isRunning = true;
-  *PIT_TCTRL = 3;
-  NVIC_ENABLE_IRQ(IRQ_PIT_CH);
-}
-
-
-
-// ------------------------------------------------------------
-// clears the timer flag, allowing further interrupts to occur.
-// this is handled automatically by the PIT ISR wrappers above.
-// this function also increases the execution counter by one
-// ------------------------------------------------------------
-void PITimer::clear() {
-  *PIT_TFLG = 1;
-  myCount++;
-}
-
-
-
-// ------------------------------------------------------------
-// calling this function causes the current countdown cycle of the
-// timer to reset, essentially delaying the firing of the callback
-// until another full period of the timer's cycle has elapsed.
-// ------------------------------------------------------------
-void PITimer::reset() {
-  *PIT_TCTRL = 1;
-  *PIT_TCTRL = 3;
-}
-
-
-
-// ------------------------------------------------------------
-// stops the timer and disables its interrupts
-// ------------------------------------------------------------
-void PITimer::stop() {
-  isRunning = false;
-  NVIC_DISABLE_IRQ(IRQ_PIT_CH);
-  *PIT_TCTRL = 0;
-}
-
-
-
-// ------------------------------------------------------------
-// check to see if the timer is currently active
-// ------------------------------------------------------------
-bool PITimer::running() {
-  return isRunning;
-}
-
-
-
-// ------------------------------------------------------------
-// returns the number of times this timer has executed
-// ------------------------------------------------------------
-uint32_t PITimer::count() {
-  return myCount;
-}
-
-
-
-// ------------------------------------------------------------
-// resets the execution counter back to zero
-// ------------------------------------------------------------
-void PITimer::zero() {
-  myCount = 0;
-}
-
-
-
-// ------------------------------------------------------------
-// returns the number of bus clock cycles
-// remaining until the timer will fire next.
-// this number decreases until it reaches 0
+// the ISR budgets of the four channels (see budget()), all 0
+// until they're set
 // ------------------------------------------------------------
-uint32_t PITimer::current() {
-  return *PIT_CVAL;
-}
-
+uint32_t PITimerBase::myBudgets[4];
 
 
-// ------------------------------------------------------------
-// returns the amount of time (in seconds)
-// until the timer will fire next
-// ------------------------------------------------------------
-float PITimer::remains() {
-  return current() / float(F_BUS);
-}
+
+// ------------------------------------------------------------
+// the ISR each channel installed when it was last started (see
+// pit0_isr() and friends, above)
+// ------------------------------------------------------------
+void (*PITimerBase::myHandlers[4])();
+
+
+
+// ------------------------------------------------------------
+// response-time analysis for the start of a channel's ISR. a
+// less urgent ISR gets preempted straight away, but one at the
+// same level runs to the end first, so the worst case starts with
+// the longest budget among those (the blocking term). on top of
+// that, every
+// more urgent channel can fire again and again in the meantime:
+// the wait is grown by their budgets until it stops changing, or
+// until it reaches the channel's own period. periods are read from
+// LDVAL, so a timer whose period keeps changing (a PITimerWheel,
+// say) is treated as if its current one were its only one.
+// interrupts other than the PIT's, and the few cycles the core
+// takes to enter an ISR, aren't counted
+// ------------------------------------------------------------
+uint32_t PITimerBase::worstLatency(uint8_t channel) {
+  uint8_t level = NVIC_GET_PRIORITY(IRQ_PIT_CH0 + channel) >> 4;
+  uint64_t limit = uint64_t(PIT_CH(channel).ldval) + 1;
+  uint64_t blocking = 0;
+  for (uint8_t ch = 0; ch < 4; ch++) {
+    if (ch == channel || !(PIT_CH(ch).tctrl & 2)) continue;
+    if ((NVIC_GET_PRIORITY(IRQ_PIT_CH0 + ch) >> 4) == level && myBudgets[ch] > blocking) blocking = myBudgets[ch];
+  }
+  uint64_t wait = blocking;
+  for (;;) {
+    uint64_t next = blocking;
+    for (uint8_t ch = 0; ch < 4; ch++) {
+      if (ch == channel || !(PIT_CH(ch).tctrl & 2)) continue;
+      if ((NVIC_GET_PRIORITY(IRQ_PIT_CH0 + ch) >> 4) >= level) continue;
+      uint64_t period = uint64_t(PIT_CH(ch).ldval) + 1;
+      next += (wait / period + 1) * myBudgets[ch];
+    }
+    if (next >= limit) return UINT32_MAX;
+    if (next == wait) return wait;
+    wait = next;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// forwards a call to the PITimerChannel selected by myID.
+// each case is a direct call with constant register addresses,
+// so the only runtime cost of the shim is this one switch
+// ------------------------------------------------------------
+#define PITIMER_FORWARD(call) \
+  switch (myID) { \
+    case 0:  return PITimerChannel<0>::call; \
+    case 1:  return PITimerChannel<1>::call; \
+    case 2:  return PITimerChannel<2>::call; \
+    default: return PITimerChannel<3>::call; \
+  }
+
+
+
+// ------------------------------------------------------------
+// these are documented alongside their implementations in
+// PITimerChannel.h
+// ------------------------------------------------------------
+void PITimer::begin() { PITIMER_FORWARD(begin()); }
+void PITimer::value(uint32_t newValue) { PITIMER_FORWARD(value(newValue)); }
+void PITimer::load(uint32_t newValue) { PITIMER_FORWARD(load(newValue)); }
+void PITimer::period(float newPeriod) { PITIMER_FORWARD(period(newPeriod)); }
+void PITimer::frequency(float newFrequency) { PITIMER_FORWARD(frequency(newFrequency)); }
+void PITimer::period(PITimerConstant newPeriod) { PITIMER_FORWARD(period(newPeriod)); }
+void PITimer::frequency(PITimerConstant newFrequency) { PITIMER_FORWARD(frequency(newFrequency)); }
+uint32_t PITimer::value() { PITIMER_FORWARD(value()); }
+uint32_t PITimer::current() { PITIMER_FORWARD(current()); }
+bool PITimer::expired() { PITIMER_FORWARD(expired()); }
+float PITimer::period() { PITIMER_FORWARD(period()); }
+float PITimer::frequency() { PITIMER_FORWARD(frequency()); }
+void PITimer::start(const PITimerCallback& newCallback) { PITIMER_FORWARD(start(newCallback)); }
+void PITimer::start(void (*newFunction)(void*), void* newContext) { PITIMER_FORWARD(start(newFunction, newContext)); }
+void PITimer::trigger() { PITIMER_FORWARD(trigger()); }
+void PITimer::once(const PITimerCallback& newCallback) { PITIMER_FORWARD(once(newCallback)); }
+void PITimer::once(void (*newFunction)(void*), void* newContext) { PITIMER_FORWARD(once(newFunction, newContext)); }
+void PITimer::retrigger() { PITIMER_FORWARD(retrigger()); }
+void PITimer::clear() { PITIMER_FORWARD(clear()); }
+void PITimer::reset() { PITIMER_FORWARD(reset()); }
+void PITimer::stop() { PITIMER_FORWARD(stop()); }
+bool PITimer::running() { PITIMER_FORWARD(running()); }
+uint32_t PITimer::count() { PITIMER_FORWARD(count()); }
+void PITimer::zero() { PITIMER_FORWARD(zero()); }
+void PITimer::overrun(PITimerOverrun newPolicy, const PITimerCallback& newHandler) { PITIMER_FORWARD(overrun(newPolicy, newHandler)); }
+uint32_t PITimer::overruns() { PITIMER_FORWARD(overruns()); }
+void PITimer::queue(PITimerQueueBase* newQueue) { PITIMER_FORWARD(queue(newQueue)); }
+void PITimer::priority(uint8_t newPriority) { PITIMER_FORWARD(priority(newPriority)); }
+uint8_t PITimer::priority() { PITIMER_FORWARD(priority()); }
+void PITimer::budget(uint32_t cycles) { PITIMER_FORWARD(budget(cycles)); }
+uint32_t PITimer::budget() { PITIMER_FORWARD(budget()); }
+uint32_t PITimer::latency() { PITIMER_FORWARD(latency()); }
+float PITimer::remains() { PITIMER_FORWARD(remains()); }
+void PITimer::periodNanos(uint64_t newPeriod) { PITIMER_FORWARD(periodNanos(newPeriod)); }
+void PITimer::periodMicros(uint32_t newPeriod) { PITIMER_FORWARD(periodMicros(newPeriod)); }
+void PITimer::frequencyMillihertz(uint32_t newFrequency) { PITIMER_FORWARD(frequencyMillihertz(newFrequency)); }
+uint64_t PITimer::periodNanos() { PITIMER_FORWARD(periodNanos()); }
+uint32_t PITimer::periodMicros() { PITIMER_FORWARD(periodMicros()); }
+uint32_t PITimer::frequencyMillihertz() { PITIMER_FORWARD(frequencyMillihertz()); }
+void PITimer::frequencyExact(uint32_t num, uint32_t den) { PITIMER_FORWARD(frequencyExact(num, den)); }
+bool PITimer::dithering() { PITIMER_FORWARD(dithering()); }
+uint32_t PITimer::phaseError() { PITIMER_FORWARD(phaseError()); }
+uint64_t PITimer::remainsNanos() { PITIMER_FORWARD(remainsNanos()); }
+uint32_t PITimer::remainsMicros() { PITIMER_FORWARD(remainsMicros()); }
+void PITimer::discard() { PITIMER_FORWARD(discard()); }
+uint64_t PITimer::now() { PITIMER_FORWARD(now()); }
+uint64_t PITimer::nowNanos() { PITIMER_FORWARD(nowNanos()); }
+#if PITIMER_PROFILE
+PITimerProfile PITimer::profile() { PITIMER_FORWARD(profile()); }
+void PITimer::profileZero() { PITIMER_FORWARD(profileZero()); }
+#endif
+void PITimer::arm(const PITimerCallback& newCallback, uint32_t offset) { PITIMER_FORWARD(arm(newCallback, offset)); }
+void PITimer::launch() { PITIMER_FORWARD(launch()); }
 
 
 
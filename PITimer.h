@@ -9,46 +9,87 @@
 
 
 
+#include "PITimerChannel.h"
 #include <stdint.h>
 
 
 
-typedef volatile uint32_t* reg;
-
-
-
+// ------------------------------------------------------------
+// runtime-numbered timer object. all of the actual work is done
+// by PITimerChannel<N> (see PITimerChannel.h), this class only
+// forwards each call to the channel selected by myID. sketches
+// which know their channel at compile time can use the template
+// directly and skip the forwarding altogether. since the
+// forwarding refers to every channel, that also leaves the
+// channels they don't use out of the image. constructing one
+// touches no hardware: the channel brings itself up the first
+// time it's used (see PITimerChannel<N>::wake). the object holds
+// nothing but myID, so the old public myISR member is gone
+// ------------------------------------------------------------
 class PITimer {
   private:
+    friend class PITimerGroup;
     uint8_t myID;
-    uint32_t myValue;
-    uint32_t myCount;
-    bool isRunning;
-    void writeValue();
-    float roundFloat(float value);
-    static const uint16_t valueMin = 639;
-    reg PIT_LDVAL;
-    reg PIT_TCTRL;
-    reg PIT_TFLG;
-    reg PIT_CVAL;
-    uint8_t IRQ_PIT_CH;
+    void arm(const PITimerCallback& newCallback, uint32_t offset);
+    void launch();
   public:
-    PITimer(uint8_t timerID);
+    constexpr PITimer(uint8_t timerID) : myID(timerID) {}
+    uint8_t id() { return myID; }
+    void begin();
     void value(uint32_t newValue);
+    void load(uint32_t newValue);
     void period(float newPeriod);
     void frequency(float newFrequency);
+    void period(PITimerConstant newPeriod);
+    void frequency(PITimerConstant newFrequency);
     uint32_t value();
     float period();
     float frequency();
-    void start(void (*newISR)());
+    void start(const PITimerCallback& newCallback = PITimerCallback());
+    void start(void (*newFunction)(void*), void* newContext);
+    void trigger();
+    void once(const PITimerCallback& newCallback = PITimerCallback());
+    void once(void (*newFunction)(void*), void* newContext);
+    void retrigger();
     void clear();
     void reset();
     void stop();
     bool running();
     uint32_t count();
     void zero();
+    void overrun(PITimerOverrun newPolicy, const PITimerCallback& newHandler = PITimerCallback());
+    uint32_t overruns();
+    void queue(PITimerQueueBase* newQueue);
+    void priority(uint8_t newPriority);
+    uint8_t priority();
+    void budget(uint32_t cycles);
+    uint32_t budget();
+    uint32_t latency();
     uint32_t current();
     float remains();
-    void (*myISR)();
+    template <class Duration>
+    auto period(const Duration& newPeriod) -> decltype(void(Duration::period::den));
+    template <class Duration>
+    Duration remains();
+    void periodNanos(uint64_t newPeriod);
+    void periodMicros(uint32_t newPeriod);
+    void frequencyMillihertz(uint32_t newFrequency);
+    uint64_t periodNanos();
+    uint32_t periodMicros();
+    uint32_t frequencyMillihertz();
+    void frequencyExact(uint32_t num, uint32_t den = 1);
+    bool dithering();
+    uint32_t phaseError();
+    uint64_t remainsNanos();
+    uint32_t remainsMicros();
+    bool expired();
+    void discard();
+    uint64_t now();
+    uint64_t nowNanos();
+#if PITIMER_PROFILE
+    PITimerProfile profile();
+    void profileZero();
+#endif
 };
 
 
@@ -60,6 +101,24 @@ extern PITimer PITimer2;
 
 
 
+// ------------------------------------------------------------
+// the std::chrono versions of period() and remains() have to be
+// templates, so they can't be forwarded from PITimer.cpp like the
+// rest. they do the conversion here and pass on plain cycles
+// (see PITimerChannel.h)
+// ------------------------------------------------------------
+template <class Duration>
+auto PITimer::period(const Duration& newPeriod) -> decltype(void(Duration::period::den)) {
+  value(PITimerMath::checkedValue(PITimerRatio<typename Duration::period>::cycles(newPeriod.count())));
+}
+
+template <class Duration>
+Duration PITimer::remains() {
+  return Duration(typename Duration::rep(PITimerRatio<typename Duration::period>::count(current())));
+}
+
+
+
 #endif
 
 
@@ -0,0 +1,156 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerADC.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// the PITimerADC currently running, for the DMA ISR to find
+// ------------------------------------------------------------
+PITimerADC* PITimerADC::myActive = 0;
+
+
+
+// ------------------------------------------------------------
+// ADC channel numbers for the analog pins A0-A15 of the Teensy
+// 3.0, the same ones analogRead() uses
+// ------------------------------------------------------------
+static const uint8_t PITimerADCChannels[] = {
+  5, 14, 8, 9, 13, 12, 6, 7, 15, 4, 0, 19, 3, 21, 26, 22
+};
+
+
+
+// ------------------------------------------------------------
+// initializer for the PITimerADC class. the timer sets the
+// sample rate, via its usual functions (or load(), for rates
+// beyond its ISR limit). nothing touches the hardware until
+// start() is called
+// ------------------------------------------------------------
+PITimerADC::PITimerADC(PITimer& timer) :
+  myTimer(timer), myBuffer(0), myBlockSize(0), myBlock(0), myBlocks(0) {
+}
+
+
+
+// ------------------------------------------------------------
+// starts sampling pin (A0-A15, or the matching digital pin
+// numbers 14-23 just like analogRead()) into buffer, which has
+// to hold two blocks of blockSize samples each, and stay valid
+// until stop(). the callback, if any, runs each time a block is
+// full. returns false (and does nothing) if the pin isn't an
+// analog input or blockSize is 0 or more than blockMax
+// ------------------------------------------------------------
+bool PITimerADC::start(uint8_t pin, uint16_t* buffer, uint16_t blockSize, const PITimerCallback& newCallback) {
+  if (pin >= 14 && pin <= 23) pin -= 14;
+  if (pin >= sizeof(PITimerADCChannels) || blockSize == 0 || blockSize > blockMax) return false;
+  if (myActive) myActive->stop();
+  myBuffer = buffer;
+  myBlockSize = blockSize;
+  myBlock = 0;
+  myBlocks = 0;
+  myCallback = newCallback;
+  SIM_SCGC6 |= SIM_SCGC6_DMAMUX;
+  SIM_SCGC7 |= SIM_SCGC7_DMA;
+  DMA_CERQ = dmaChannel;
+  PIT_DMAMUX(dmaChannel) = 0;
+  tcd().saddr = (uintptr_t)&ADC0_RA;
+  tcd().soff = 0;
+  tcd().attr = (1 << 8) | 1;
+  tcd().nbytes = 2;
+  tcd().slast = 0;
+  tcd().daddr = (uintptr_t)buffer;
+  tcd().doff = 2;
+  tcd().citer = blockSize * 2;
+  tcd().dlastsga = -int32_t(blockSize) * 4;
+  tcd().biter = blockSize * 2;
+  tcd().csr = csrHalf | csrMajor;
+  PIT_DMAMUX(dmaChannel) = muxEnable | muxADC0;
+  myActive = this;
+  myHandlers[dmaChannel] = isr;
+  NVIC_ENABLE_IRQ(IRQ_DMA_CH0 + dmaChannel);
+  DMA_SERQ = dmaChannel;
+  ADC0_SC2 |= sc2Trigger | sc2DMA;
+  SIM_SOPT7 = sopt7Alternate | (sopt7PIT0 + myTimer.id());
+  ADC0_SC1A = PITimerADCChannels[pin];
+  myTimer.trigger();
+  return true;
+}
+
+
+
+// ------------------------------------------------------------
+// stops the timer and the sampling, and hands the ADC back to
+// analogRead(). a block that was only partly filled is dropped
+// ------------------------------------------------------------
+void PITimerADC::stop() {
+  if (myActive != this) return;
+  myTimer.stop();
+  DMA_CERQ = dmaChannel;
+  NVIC_DISABLE_IRQ(IRQ_DMA_CH0 + dmaChannel);
+  PIT_DMAMUX(dmaChannel) = 0;
+  SIM_SOPT7 = 0;
+  ADC0_SC2 &= ~(sc2Trigger | sc2DMA);
+  ADC0_SC1A = sc1Disabled;
+  myActive = 0;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if this PITimerADC is currently sampling
+// ------------------------------------------------------------
+bool PITimerADC::running() {
+  return myActive == this;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the block that was filled most recently, or 0 if none
+// has been yet. it's only safe to read until the next one fills,
+// which is a whole block's worth of periods away
+// ------------------------------------------------------------
+const uint16_t* PITimerADC::block() {
+  return myBlock;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of blocks filled since start(). if this goes
+// up by more than one between reads, some blocks were missed
+// ------------------------------------------------------------
+uint32_t PITimerADC::blocks() {
+  return myBlocks;
+}
+
+
+
+// ------------------------------------------------------------
+// the body of the DMA ISR, installed by start() for dma_ch3_isr()
+// in PITimerDMA.cpp. it runs twice per buffer, once per block.
+// the DONE bit tells the end of the buffer (second block) apart
+// from its halfway point (first block)
+// ------------------------------------------------------------
+void PITimerADC::isr() {
+  DMA_CINT = dmaChannel;
+  PITimerADC* adc = myActive;
+  if (!adc) return;
+  if (tcd().csr & csrDone) {
+    DMA_CDNE = dmaChannel;
+    adc->myBlock = adc->myBuffer + adc->myBlockSize;
+  }
+  else adc->myBlock = adc->myBuffer;
+  adc->myBlocks++;
+  adc->myCallback();
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERADC_H__
+#define __PITIMERADC_H__
+
+
+
+#include "PITimer.h"
+#include "PITimerDMA.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// samples an analog pin on every period of a PIT channel, with
+// no interrupt per sample. the PIT is routed to ADC0's hardware
+// trigger (SIM_SOPT7), so each conversion starts exactly when the
+// timer expires, and every result is moved by DMA (on DMA channel
+// 3, which PITimerDMA doesn't use) into a buffer made of two
+// blocks. when a block fills up, the callback runs (from the DMA
+// ISR) while the other block fills. the ADC is used as set up by
+// the Teensy core (see analogReadResolution() and friends), and
+// there's only one ADC0, so only one PITimerADC can run at a time
+// ------------------------------------------------------------
+class PITimerADC : public PITimerDMABase {
+  private:
+    static const uint8_t dmaChannel = 3;
+    static const uint8_t muxEnable = 0x80;
+    static const uint8_t muxADC0 = 40;
+    static const uint16_t csrMajor = 0x0002;
+    static const uint16_t csrHalf = 0x0004;
+    static const uint16_t csrDone = 0x0080;
+    static const uint32_t sc2Trigger = 0x40;
+    static const uint32_t sc2DMA = 0x04;
+    static const uint32_t sopt7Alternate = 0x80;
+    static const uint32_t sopt7PIT0 = 4;
+    static const uint8_t sc1Disabled = 0x1F;
+    static PITimerADC* myActive;
+    PITimer& myTimer;
+    uint16_t* myBuffer;
+    uint16_t myBlockSize;
+    const uint16_t* volatile myBlock;
+    volatile uint32_t myBlocks;
+    PITimerCallback myCallback;
+    static PITimerTCD& tcd() { return PIT_DMA_TCD(dmaChannel); }
+  public:
+    static const uint16_t blockMax = 16383;
+    PITimerADC(PITimer& timer);
+    bool start(uint8_t pin, uint16_t* buffer, uint16_t blockSize, const PITimerCallback& newCallback = PITimerCallback());
+    void stop();
+    bool running();
+    const uint16_t* block();
+    uint32_t blocks();
+    static void isr();
+};
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,142 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERCALLBACK_H__
+#define __PITIMERCALLBACK_H__
+
+
+
+#include "PITimerConfig.h"
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <type_traits>
+
+
+
+// ------------------------------------------------------------
+// a callback that can carry its own context. it holds a function
+// taking a void* and the pointer to hand it, so the channel's ISR
+// dispatches it with one load of each and an indirect call. on
+// the Cortex-M4 that's one load (about two cycles) more than
+// calling a bare function pointer. the accepted forms are:
+//
+//  - a plain function taking no arguments (as before)
+//  - a function taking a void*, plus the context to pass it
+//  - a member function, via bind<Class, &Class::method>(object)
+//  - a lambda or other functor, copied into an inline buffer of
+//    PITIMER_CALLBACK_WORDS words (see PITimerConfig.h). no heap
+//    is used, so captures must be small and trivially copyable
+//
+// plain functions are the only form which goes through a second
+// indirect call, via a small trampoline that keeps the old
+// signature legal, which adds about 5 cycles. either way, the
+// vector first reaches the channel's ISR through the handler it
+// installed (see pit0_isr() in PITimer.cpp), which is one more
+// indirect call. from the vector, a plain function is three
+// indirect calls away, about 10 cycles more than when a timer
+// only held a function pointer, and every other form is two, or
+// about 5 cycles more.
+// extras/tests/Benchmark.cpp compares the forms on the host
+// ------------------------------------------------------------
+class PITimerCallback {
+  private:
+    void (*myFunction)(void*);
+    void* myContext;
+    union {
+      void* words[PITIMER_CALLBACK_WORDS];
+      void (*plain)();
+    } myStorage;
+    bool usesStorage() const { return myContext == &myStorage; }
+    static void callNothing(void*) {}
+    static void callPlain(void* storage) { (*static_cast<void (**)()>(storage))(); }
+    template <class F> static void callFunctor(void* functor) { (*static_cast<F*>(functor))(); }
+    template <class T, void (T::*M)()> static void callMember(void* object) { (static_cast<T*>(object)->*M)(); }
+  public:
+    constexpr PITimerCallback() : myFunction(callNothing), myContext(0), myStorage() {}
+    PITimerCallback(void (*function)());
+    PITimerCallback(void (*function)(void*), void* context);
+    template <class F> PITimerCallback(const F& functor);
+    PITimerCallback(const PITimerCallback& other);
+    PITimerCallback& operator=(const PITimerCallback& other);
+    template <class T, void (T::*M)()> static PITimerCallback bind(T& object);
+    bool empty() const { return myFunction == callNothing; }
+    void operator()() const { myFunction(myContext); }
+};
+
+
+
+// ------------------------------------------------------------
+// wraps a plain function with no arguments. the pointer lives in
+// the inline buffer and a trampoline calls through it
+// ------------------------------------------------------------
+inline PITimerCallback::PITimerCallback(void (*function)()) : myFunction(callPlain), myContext(&myStorage) {
+  myStorage.plain = function;
+}
+
+
+
+// ------------------------------------------------------------
+// a function taking a void*, and the context to pass it
+// ------------------------------------------------------------
+inline PITimerCallback::PITimerCallback(void (*function)(void*), void* context) : myFunction(function), myContext(context) {
+}
+
+
+
+// ------------------------------------------------------------
+// copies a lambda (or any functor) into the inline buffer. the
+// checks here turn an oversized or non-trivial capture into a
+// compile error rather than a heap allocation
+// ------------------------------------------------------------
+template <class F>
+inline PITimerCallback::PITimerCallback(const F& functor) : myFunction(callFunctor<F>), myContext(&myStorage), myStorage() {
+  static_assert(sizeof(F) <= sizeof(myStorage), "PITimerCallback: captures too large, raise PITIMER_CALLBACK_WORDS");
+  static_assert(alignof(F) <= alignof(void*), "PITimerCallback: captures need more alignment than a pointer");
+  static_assert(std::is_trivially_copyable<F>::value, "PITimerCallback: captures must be trivially copyable");
+  new (&myStorage) F(functor);
+}
+
+
+
+// ------------------------------------------------------------
+// copying has to re-point the context at our own buffer
+// whenever the original was using its buffer
+// ------------------------------------------------------------
+inline PITimerCallback::PITimerCallback(const PITimerCallback& other) {
+  *this = other;
+}
+
+inline PITimerCallback& PITimerCallback::operator=(const PITimerCallback& other) {
+  myFunction = other.myFunction;
+  myContext = other.myContext;
+  if (other.usesStorage()) {
+    myContext = &myStorage;
+    memcpy(&myStorage, &other.myStorage, sizeof(myStorage));
+  }
+  return *this;
+}
+
+
+
+// ------------------------------------------------------------
+// binds a member function of an object, e.g. for a class Motor
+// with a method step(), bind<Motor, &Motor::step>(motor). the
+// member is a template argument, so the call through the object
+// is resolved at compile time and the object is the context
+// ------------------------------------------------------------
+template <class T, void (T::*M)()>
+inline PITimerCallback PITimerCallback::bind(T& object) {
+  return PITimerCallback(callMember<T, M>, &object);
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,1112 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERCHANNEL_H__
+#define __PITIMERCHANNEL_H__
+
+
+
+#include "PITimerPort.h"
+#include "PITimerMath.h"
+#include "PITimerCallback.h"
+#include "PITimerProfile.h"
+#include "PITimerQueue.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// state and helpers shared by every channel, independent of N
+// ------------------------------------------------------------
+class PITimerBase : public PITimerMath {
+  protected:
+    static uint32_t myBudgets[4];
+    static void (*myHandlers[4])();
+    static float roundFloat(float value);
+    static uint32_t worstLatency(uint8_t channel);
+  public:
+    static void dispatch(uint8_t channel) { myHandlers[channel](); }
+};
+
+
+
+// ------------------------------------------------------------
+// what a timer does when its callback runs past the next expiry
+// (see overrun() below)
+// ------------------------------------------------------------
+enum PITimerOverrun {
+  PITIMER_BURST,
+  PITIMER_SKIP
+};
+
+
+
+// ------------------------------------------------------------
+// compile-time PIT channel. the channel number is a template
+// parameter, so register addresses and the IRQ number are
+// constants and every member is static: each register access is a
+// single load or store at a literal address, with no pointer
+// chase. current() is one flag test (see wake()) and that load.
+// clear() does more than its store, since it also keeps count()
+// and now() up to date. the PITimer class in PITimer.h is a thin
+// runtime shim over these, kept for compatibility with existing
+// sketches
+// ------------------------------------------------------------
+template <uint8_t N>
+class PITimerChannel : public PITimerBase {
+  private:
+    friend class PITimer;
+    static uint32_t myValue;
+    static uint32_t myCount;
+    static uint32_t myOverruns;
+    static uint32_t myLoaded;
+    static uint64_t myCycles;
+    static volatile uint32_t mySeq;
+    static uint32_t myDitherBase;
+    static uint32_t myDitherMod;
+    static uint32_t myDitherRem;
+    static uint32_t myDitherAcc;
+    static bool isRunning;
+    static bool isDithering;
+    static bool isOneShot;
+    static bool isAwake;
+    static PITimerOverrun myPolicy;
+    static PITimerCallback myCallback;
+    static PITimerCallback myOverrunHandler;
+    static PITimerQueueBase* myQueue;
+#if PITIMER_PROFILE
+    static PITimerProfile myProfile;
+    static volatile uint32_t myProfileSeq;
+#endif
+    static void wake();
+    static void writeValue();
+    static void account();
+    static void expire();
+    static void skip();
+    static void dither();
+    static void arm(const PITimerCallback& newCallback, uint32_t offset);
+    static void launch();
+    static PITimerReg& ldval() { return PIT_CH(N).ldval; }
+    static PITimerReg& cval()  { return PIT_CH(N).cval; }
+    static PITimerReg& tctrl() { return PIT_CH(N).tctrl; }
+    static PITimerReg& tflg()  { return PIT_CH(N).tflg; }
+  public:
+    static const uint8_t id = N;
+    static const uint8_t irq = IRQ_PIT_CH0 + N;
+    static void begin();
+    static void value(uint32_t newValue);
+    static void load(uint32_t newValue);
+    static void period(float newPeriod);
+    static void frequency(float newFrequency);
+    static void period(PITimerConstant newPeriod);
+    static void frequency(PITimerConstant newFrequency);
+    static uint32_t value();
+    static float period();
+    static float frequency();
+    static void start(const PITimerCallback& newCallback = PITimerCallback());
+    static void start(void (*newFunction)(void*), void* newContext);
+    static void trigger();
+    static void once(const PITimerCallback& newCallback = PITimerCallback());
+    static void once(void (*newFunction)(void*), void* newContext);
+    static void retrigger();
+    static void clear();
+    static void reset();
+    static void stop();
+    static bool running();
+    static uint32_t count();
+    static void zero();
+    static void overrun(PITimerOverrun newPolicy, const PITimerCallback& newHandler = PITimerCallback());
+    static uint32_t overruns();
+    static void queue(PITimerQueueBase* newQueue);
+    static void priority(uint8_t newPriority);
+    static uint8_t priority();
+    static void budget(uint32_t cycles);
+    static uint32_t budget();
+    static uint32_t latency();
+    static uint32_t current();
+    static float remains();
+    template <class Duration>
+    static auto period(const Duration& newPeriod) -> decltype(void(Duration::period::den));
+    template <class Duration>
+    static Duration remains();
+    static void periodNanos(uint64_t newPeriod);
+    static void periodMicros(uint32_t newPeriod);
+    static void frequencyMillihertz(uint32_t newFrequency);
+    static uint64_t periodNanos();
+    static uint32_t periodMicros();
+    static uint32_t frequencyMillihertz();
+    static void frequencyExact(uint32_t num, uint32_t den = 1);
+    static bool dithering();
+    static uint32_t phaseError();
+    static uint64_t remainsNanos();
+    static uint32_t remainsMicros();
+    static bool expired();
+    static void discard();
+    static uint64_t now();
+    static uint64_t nowNanos();
+#if PITIMER_PROFILE
+    static PITimerProfile profile();
+    static void profileZero();
+#endif
+    static void isr();
+};
+
+
+
+template <uint8_t N> uint32_t PITimerChannel<N>::myValue = F_BUS;
+template <uint8_t N> uint32_t PITimerChannel<N>::myCount;
+template <uint8_t N> uint32_t PITimerChannel<N>::myOverruns;
+template <uint8_t N> uint32_t PITimerChannel<N>::myLoaded;
+template <uint8_t N> uint64_t PITimerChannel<N>::myCycles;
+template <uint8_t N> volatile uint32_t PITimerChannel<N>::mySeq;
+template <uint8_t N> uint32_t PITimerChannel<N>::myDitherBase;
+template <uint8_t N> uint32_t PITimerChannel<N>::myDitherMod;
+template <uint8_t N> uint32_t PITimerChannel<N>::myDitherRem;
+template <uint8_t N> uint32_t PITimerChannel<N>::myDitherAcc;
+template <uint8_t N> bool PITimerChannel<N>::isRunning;
+template <uint8_t N> bool PITimerChannel<N>::isDithering;
+template <uint8_t N> bool PITimerChannel<N>::isOneShot;
+template <uint8_t N> bool PITimerChannel<N>::isAwake;
+template <uint8_t N> PITimerOverrun PITimerChannel<N>::myPolicy;
+template <uint8_t N> PITimerCallback PITimerChannel<N>::myCallback;
+template <uint8_t N> PITimerCallback PITimerChannel<N>::myOverrunHandler;
+template <uint8_t N> PITimerQueueBase* PITimerChannel<N>::myQueue;
+#if PITIMER_PROFILE
+template <uint8_t N> PITimerProfile PITimerChannel<N>::myProfile;
+template <uint8_t N> volatile uint32_t PITimerChannel<N>::myProfileSeq;
+#endif
+
+
+
+// ------------------------------------------------------------
+// brings up the PIT the first time the channel is used, so that
+// nothing has to run at startup (see begin(), below). this turns
+// on the PIT's clock and the module itself, which every channel
+// shares, and loads the period the channel already has (myValue
+// starts out as F_BUS, for 1 second). until then, the PIT can't
+// even be read (it bus faults), so everything that touches the
+// channel calls this first, down to current() and expired().
+// once the PIT is up, that's one flag test
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::wake() {
+  if (isAwake) return;
+  SIM_SCGC6 |= SIM_SCGC6_PIT;
+  PIT_MCR = 0;
+  isAwake = true;
+  ldval() = myValue;
+}
+
+
+
+// ------------------------------------------------------------
+// the actual period of a timer is stored as a quantity
+// of bus clock cycles, and that's what "value" represents.
+// all this function does is perform the register write.
+// it needs to be called whenever myValue is changed. since the
+// value was set explicitly, it also puts an end to dithering
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::writeValue() {
+  isDithering = false;
+  wake();
+  ldval() = myValue;
+}
+
+
+
+// ------------------------------------------------------------
+// brings up the channel with its defaults. F_BUS is equal to the
+// frequency of the bus clock. we're also enabling the overall
+// clock access to the PIT module, both via the SIM (System
+// Integration Module) and the PIT's own MCR (Module Control
+// Register). enabling these global controls for each timer
+// isn't necessary, but it doesn't do any harm either.
+// none of this has to be called any more, since the channel
+// brings itself up when it's first used (see wake(), above), but
+// it still puts a channel back to its defaults
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::begin() {
+  SIM_SCGC6 |= SIM_SCGC6_PIT;
+  PIT_MCR = 0;
+  isAwake = true;
+  value(F_BUS);
+}
+
+
+
+// ------------------------------------------------------------
+// this version of value() (with an argument) is used to set the
+// timer value directly, either by the user, or by one of the other
+// (more useful) set functions. only useful externally if the timer
+// needs to perform some kind of bus-clock-specific function.
+// includes some basic range validation. timer behavior seems to
+// become unstable at very low values or at 2^32-1 (UINT32_MAX)
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::value(uint32_t newValue) {
+  if (newValue == UINT32_MAX) newValue = UINT32_MAX - 1;
+  else if (newValue < valueMin) newValue = valueMin;
+  myValue = newValue;
+  writeValue();
+}
+
+
+
+// ------------------------------------------------------------
+// sets the timer value without the lower limit that value()
+// applies. that limit only exists because the ISR has to keep
+// up, so this is meant for a timer started with trigger(), which
+// has no ISR and can run at rates far beyond it (see below)
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::load(uint32_t newValue) {
+  if (newValue == UINT32_MAX) newValue = UINT32_MAX - 1;
+  myValue = newValue;
+  writeValue();
+}
+
+
+
+// ------------------------------------------------------------
+// this version of period() (with an argument) is used to set the
+// period of the timer in terms of units of time (seconds).
+// for 48 MHz bus, range is about 14 ns (0.000014) to 89 s (89.0)
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::period(float newPeriod) {
+  uint32_t newValue = roundFloat(F_BUS * newPeriod) - 1;
+  value(newValue);
+}
+
+
+
+// ------------------------------------------------------------
+// this version of frequency() (with an argument) is used to set the
+// frequency of the timer in terms of hertz (1 cycle per second).
+// for 48 MHz bus, range is about 12 mHz (0.012) to 75 kHz (75000)
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::frequency(float newFrequency) {
+  uint32_t newValue = roundFloat(F_BUS / newFrequency) - 1;
+  value(newValue);
+}
+
+
+
+// ------------------------------------------------------------
+// get the current value of the timer (in bus clock cycles)
+// ------------------------------------------------------------
+template <uint8_t N>
+inline uint32_t PITimerChannel<N>::value() {
+  return myValue;
+}
+
+
+
+// ------------------------------------------------------------
+// get the current period of the timer (in seconds)
+// ------------------------------------------------------------
+template <uint8_t N>
+float PITimerChannel<N>::period() {
+  return (value() + 1) / float(F_BUS);
+}
+
+
+
+// ------------------------------------------------------------
+// get the current frequency of the timer (in hertz)
+// ------------------------------------------------------------
+template <uint8_t N>
+float PITimerChannel<N>::frequency() {
+  return float(F_BUS) / (value() + 1);
+}
+
+
+
+// ------------------------------------------------------------
+// this function initializes and starts the timer, using the specified
+// callback. this can be the name of a function taking no arguments and
+// returning void, a lambda, or anything else PITimerCallback accepts
+// (see PITimerCallback.h). make sure the callback can complete
+// within the time allowed (aka less than its period). starting a
+// timer that's already running restarts its countdown, like
+// reset(), and now() keeps counting from where it was
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::start(const PITimerCallback& newCallback) {
+  PITimerLock lock;
+  wake();
+  isOneShot = false;
+  myCallback = newCallback;
+  isRunning = true;
+  if (tctrl() & 2) account();
+  else {
+    myLoaded = myValue;
+    mySeq++;
+  }
+  tctrl() = 0;
+  tctrl() = 3;
+  if (isDithering) dither();
+  myHandlers[N] = isr;
+  NVIC_ENABLE_IRQ(irq);
+}
+
+
+
+// ------------------------------------------------------------
+// same as above, for a function which takes a void* argument.
+// newContext is passed to it each time the timer fires, which
+// is usually a pointer to the object the callback works on
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::start(void (*newFunction)(void*), void* newContext) {
+  start(PITimerCallback(newFunction, newContext));
+}
+
+
+
+// ------------------------------------------------------------
+// starts the timer in one-shot mode: it fires once, one period
+// from now, and then stops by itself (the ISR wrapper disables it
+// before the callback runs, so the callback is free to start it
+// again). retrigger() pushes the deadline back out, so this is
+// the one for timeouts: debouncing, idle detection, or the gap
+// between the bytes of a message. start() and trigger() go back
+// to periodic mode
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::once(const PITimerCallback& newCallback) {
+  PITimerLock lock;
+  start(newCallback);
+  isOneShot = true;
+}
+
+template <uint8_t N>
+inline void PITimerChannel<N>::once(void (*newFunction)(void*), void* newContext) {
+  once(PITimerCallback(newFunction, newContext));
+}
+
+
+
+// ------------------------------------------------------------
+// restarts the countdown, so that the timer fires one full period
+// from now, whether it was still counting down, had already fired
+// (as a one-shot), or had expired without its ISR having run yet,
+// in which case that expiry is thrown away: the deadline has
+// moved. it keeps the callback and the mode (one-shot or
+// periodic), and only touches the channel's own registers, so
+// it's cheap enough to call on every byte or every edge
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::retrigger() {
+  PITimerLock lock;
+  wake();
+  if (tctrl() & 2) account();
+  else {
+    myLoaded = myValue;
+    mySeq++;
+  }
+  tctrl() = 0;
+  tflg() = 1;
+  tctrl() = 3;
+  NVIC_CLEAR_PENDING(irq);
+  myHandlers[N] = isr;
+  NVIC_ENABLE_IRQ(irq);
+  isRunning = true;
+  if (isDithering) dither();
+}
+
+
+
+// ------------------------------------------------------------
+// starts the timer with its interrupt disabled, so that it only
+// produces the trigger pulses the DMA and ADC can be set to react
+// to (see PITimerDMA.h). no callback runs, the flag is left
+// alone, and count() and now() don't advance
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::trigger() {
+  PITimerLock lock;
+  wake();
+  isOneShot = false;
+  isRunning = true;
+  NVIC_DISABLE_IRQ(irq);
+  tctrl() = 1;
+}
+
+
+
+// ------------------------------------------------------------
+// clears the timer flag, allowing further interrupts to occur.
+// this is handled automatically by the PIT ISR wrappers.
+// this function also increases the execution counter by one,
+// and adds the period that just ended to the cycle count used
+// by now(). that all happens with interrupts briefly disabled,
+// so that now() can never see it half done (see below)
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::clear() {
+  PITimerLock lock;
+  wake();
+  tflg() = 1;
+  myCount++;
+  expire();
+}
+
+
+
+// ------------------------------------------------------------
+// adds the period that just ended to the cycle count. the next
+// countdown was loaded from myValue when the timer expired
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::expire() {
+  myCycles += uint64_t(myLoaded) + 1;
+  myLoaded = myValue;
+  mySeq++;
+}
+
+
+
+// ------------------------------------------------------------
+// adds the part of the current countdown that has already gone
+// by to the cycle count, for when the countdown is about to be
+// cut short. the next countdown will start from myValue. if the
+// timer has expired and its ISR hasn't run yet, the period that
+// ended is added as well, the same way now() does it, and the
+// expiry is dropped (as with discard()), so the ISR can't add it
+// a second time. everything that calls this restarts or stops the
+// countdown, so there'd be nothing left for that ISR to do anyway
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::account() {
+  uint32_t current = cval();
+  if (tflg()) {
+    current = cval();
+    tflg() = 1;
+    NVIC_CLEAR_PENDING(irq);
+    expire();
+  }
+  myCycles += myLoaded - current;
+  myLoaded = myValue;
+  mySeq++;
+}
+
+
+
+// ------------------------------------------------------------
+// calling this function causes the current countdown cycle of the
+// timer to reset, essentially delaying the firing of the callback
+// until another full period of the timer's cycle has elapsed.
+// the PIT only reloads its countdown when TEN goes from 0 to 1,
+// so the timer has to be briefly disabled (not just its interrupt).
+// a timer started with trigger() keeps its interrupt disabled.
+// the countdown restarts from the period that was queued up next,
+// so a dithering timer queues another one behind it
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::reset() {
+  PITimerLock lock;
+  wake();
+  uint32_t control = tctrl();
+  if (control & 2) account();
+  tctrl() = 0;
+  tctrl() = control == 1 ? 1 : 3;
+  if (isDithering) dither();
+}
+
+
+
+// ------------------------------------------------------------
+// stops the timer and disables its interrupts
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::stop() {
+  PITimerLock lock;
+  wake();
+  if (tctrl() & 2) account();
+  isRunning = false;
+  NVIC_DISABLE_IRQ(irq);
+  tctrl() = 0;
+}
+
+
+
+// ------------------------------------------------------------
+// the two halves of start(), for PITimerGroup (see PITimerGroup.h),
+// which sets TEN on all of its timers in between. both expect
+// interrupts to be disabled already. arm() stops the timer and
+// loads LDVAL with a first period stretched by offset cycles, and
+// launch() queues up the regular period behind it, once TEN has
+// picked up the first one, and enables the interrupt
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::arm(const PITimerCallback& newCallback, uint32_t offset) {
+  wake();
+  if (tctrl() & 2) account();
+  tctrl() = 0;
+  myCallback = newCallback;
+  isRunning = true;
+  isOneShot = false;
+  myLoaded = offset > valueMax - myValue ? valueMax : myValue + offset;
+  mySeq++;
+  ldval() = myLoaded;
+}
+
+template <uint8_t N>
+void PITimerChannel<N>::launch() {
+  if (isDithering) dither();
+  else ldval() = myValue;
+  myHandlers[N] = isr;
+  NVIC_ENABLE_IRQ(irq);
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if the timer is currently active
+// ------------------------------------------------------------
+template <uint8_t N>
+inline bool PITimerChannel<N>::running() {
+  return isRunning;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of times this timer has executed
+// ------------------------------------------------------------
+template <uint8_t N>
+inline uint32_t PITimerChannel<N>::count() {
+  return myCount;
+}
+
+
+
+// ------------------------------------------------------------
+// resets the execution and overrun counters back to zero
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::zero() {
+  myCount = 0;
+  myOverruns = 0;
+}
+
+
+
+// ------------------------------------------------------------
+// sets what happens when the callback is still running when the
+// timer expires again (an overrun). the ISR checks the flag once
+// the callback returns, which costs a single load when all is
+// well. either way the overrun is counted, and newHandler (if
+// any) is called from the ISR. with PITIMER_BURST (the default)
+// the flag is left alone, so the ISR runs again straight away and
+// the late tick is only delayed. with PITIMER_SKIP the late tick
+// is dropped, and the timer carries on with the next one on
+// schedule. the PIT only has the one flag, so a callback which
+// runs over by several periods still counts as one overrun
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::overrun(PITimerOverrun newPolicy, const PITimerCallback& newHandler) {
+  PITimerLock lock;
+  myPolicy = newPolicy;
+  myOverrunHandler = newHandler;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of overruns since the last zero()
+// ------------------------------------------------------------
+template <uint8_t N>
+inline uint32_t PITimerChannel<N>::overruns() {
+  return myOverruns;
+}
+
+
+
+// ------------------------------------------------------------
+// sets a queue for the ISR to post an event to (see
+// PITimerQueue.h) each time the timer fires, before the callback
+// runs. this works with or without a callback. 0 turns it off
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::queue(PITimerQueueBase* newQueue) {
+  PITimerLock lock;
+  myQueue = newQueue;
+}
+
+
+
+// ------------------------------------------------------------
+// the timer's interrupt priority in the NVIC, from 0 (most urgent)
+// to 255. the chip only implements the top 4 bits, so there are
+// 16 levels, in steps of 16, and the Teensy core starts everything
+// at 128. an interrupt preempts a running one only if its level
+// is more urgent (lower); at the same level, it waits its turn.
+// so a fast control loop at, say, 64 can cut into a slow timer's
+// long callback at 128, but not the other way around
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::priority(uint8_t newPriority) {
+  NVIC_SET_PRIORITY(irq, newPriority);
+}
+
+template <uint8_t N>
+inline uint8_t PITimerChannel<N>::priority() {
+  return NVIC_GET_PRIORITY(irq);
+}
+
+
+
+// ------------------------------------------------------------
+// the longest this timer's ISR can run for, in bus cycles, as far
+// as latency() is concerned. it's up to the user to supply it:
+// the duration maximum from profile() is a good source (see
+// PITimerProfile.h), with some margin on top
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::budget(uint32_t cycles) {
+  myBudgets[N] = cycles;
+}
+
+template <uint8_t N>
+inline uint32_t PITimerChannel<N>::budget() {
+  return myBudgets[N];
+}
+
+
+
+// ------------------------------------------------------------
+// the worst-case delay, in bus cycles, between this timer expiring
+// and its ISR starting, caused by the other PIT channels with
+// their interrupts enabled, going by their priorities, budgets
+// and periods. returns UINT32_MAX if the timer can be held up for
+// a whole period or more. see PITimerBase::worstLatency()
+// ------------------------------------------------------------
+template <uint8_t N>
+inline uint32_t PITimerChannel<N>::latency() {
+  return worstLatency(N);
+}
+
+
+
+// ------------------------------------------------------------
+// drops an expiry instead of running the callback for it. it's
+// still accounted for in now(), but not in count()
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::skip() {
+  PITimerLock lock;
+  tflg() = 1;
+  NVIC_CLEAR_PENDING(irq);
+  expire();
+  if (isDithering) dither();
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of bus clock cycles
+// remaining until the timer will fire next.
+// this number decreases until it reaches 0
+// ------------------------------------------------------------
+template <uint8_t N>
+inline uint32_t PITimerChannel<N>::current() {
+  wake();
+  return cval();
+}
+
+
+
+// ------------------------------------------------------------
+// returns the amount of time (in seconds)
+// until the timer will fire next
+// ------------------------------------------------------------
+template <uint8_t N>
+float PITimerChannel<N>::remains() {
+  return current() / float(F_BUS);
+}
+
+
+
+// ------------------------------------------------------------
+// integer versions of period() and frequency(), for use where
+// soft-float is too slow (inside an ISR, for example). periods
+// are given in nanoseconds or microseconds and frequencies in
+// millihertz (thousandths of a hertz, so 2 kHz is 2000000).
+// the conversion is exact and rounds the same way as the float
+// versions, then goes through the same range validation. see
+// PITimerMath.h for the details
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::periodNanos(uint64_t newPeriod) {
+  myValue = PITimerNanos::value(newPeriod);
+  writeValue();
+}
+
+template <uint8_t N>
+void PITimerChannel<N>::periodMicros(uint32_t newPeriod) {
+  myValue = PITimerMicros::value(newPeriod);
+  writeValue();
+}
+
+template <uint8_t N>
+void PITimerChannel<N>::frequencyMillihertz(uint32_t newFrequency) {
+  myValue = valueFromMillihertz(newFrequency);
+  writeValue();
+}
+
+
+
+// ------------------------------------------------------------
+// get the current period (in ns or us) or frequency (in mHz)
+// of the timer, rounded to the nearest whole unit
+// ------------------------------------------------------------
+template <uint8_t N>
+uint64_t PITimerChannel<N>::periodNanos() {
+  return PITimerNanos::time(uint64_t(value()) + 1);
+}
+
+template <uint8_t N>
+uint32_t PITimerChannel<N>::periodMicros() {
+  return PITimerMicros::time(uint64_t(value()) + 1);
+}
+
+template <uint8_t N>
+uint32_t PITimerChannel<N>::frequencyMillihertz() {
+  return millihertzFromValue(value());
+}
+
+
+
+// ------------------------------------------------------------
+// sets the frequency of the timer to exactly num / den hertz on
+// average, e.g. frequencyExact(44100) or frequencyExact(30000, 1001).
+// most frequencies fall between two whole numbers of bus cycles,
+// so the timer alternates between those two, Bresenham style: a
+// phase accumulator adds the fractional part every period and the
+// longer period is used whenever it spills over. the periods
+// still vary by one cycle, but the timer never drifts more than
+// one cycle away from the ideal timeline, however long it runs.
+// the PIT only picks up a new LDVAL when it reloads, so the value
+// written from the ISR is for the period after the one that has
+// just started. dithering needs the ISR (start(), not trigger()),
+// and ends as soon as the value is set any other way. if the
+// period comes out as a whole number of cycles or is out of range,
+// this falls back to the nearest valid value
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::frequencyExact(uint32_t num, uint32_t den) {
+  PITimerLock lock;
+  if (num == 0) {
+    myValue = valueMax;
+    writeValue();
+    return;
+  }
+  uint64_t cycles = uint64_t(F_BUS) * den;
+  uint64_t divisor = gcd(cycles, num);
+  uint64_t mod = num / divisor;
+  cycles /= divisor;
+  uint64_t base = cycles / mod;
+  if (cycles % mod == 0 || base <= valueMin || base > valueMax) {
+    myValue = clampValue(divRound(cycles, mod));
+    writeValue();
+    return;
+  }
+  myDitherBase = base - 1;
+  myDitherMod = mod;
+  myDitherRem = cycles % mod;
+  myDitherAcc = 0;
+  isDithering = true;
+  dither();
+}
+
+
+
+// ------------------------------------------------------------
+// picks the value for the next period to be queued up, and
+// writes it to LDVAL. the comparison is done against the room
+// left in the accumulator, so that it never overflows
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::dither() {
+  uint32_t next = myDitherBase;
+  if (myDitherAcc >= myDitherMod - myDitherRem) {
+    myDitherAcc -= myDitherMod - myDitherRem;
+    next++;
+  }
+  else myDitherAcc += myDitherRem;
+  myValue = next;
+  ldval() = next;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if the timer is currently dithering
+// ------------------------------------------------------------
+template <uint8_t N>
+inline bool PITimerChannel<N>::dithering() {
+  return isDithering;
+}
+
+
+
+// ------------------------------------------------------------
+// how far the timer is ahead of the ideal timeline, as of the
+// last period queued up, in 65536ths of a bus cycle. it always
+// stays below 65536 (one cycle), which is the long-term error of
+// a dithering timer. it's 0 when the timer isn't dithering
+// ------------------------------------------------------------
+template <uint8_t N>
+uint32_t PITimerChannel<N>::phaseError() {
+  PITimerLock lock;
+  if (!isDithering) return 0;
+  return (uint64_t(myDitherAcc) << 16) / myDitherMod;
+}
+
+
+
+// ------------------------------------------------------------
+// period() and frequency() for a value worked out at compile
+// time, e.g. period(50_us) or frequency(2000_Hz) (see
+// PITimerLiterals.h). it's already been range checked, so it's
+// stored as it is. the two are the same, since a period and a
+// frequency both end up as a number of cycles
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::period(PITimerConstant newPeriod) {
+  myValue = newPeriod.value;
+  writeValue();
+}
+
+template <uint8_t N>
+void PITimerChannel<N>::frequency(PITimerConstant newFrequency) {
+  myValue = newFrequency.value;
+  writeValue();
+}
+
+
+
+// ------------------------------------------------------------
+// period() and remains() for std::chrono durations, e.g.
+// period(std::chrono::microseconds(50)) or
+// remains<std::chrono::microseconds>(). these are templates, so
+// any type with a count() and a std::ratio period will do, and
+// PITimerChannel.h needn't include <chrono> (PITimerChrono.h
+// does, and adds a clock). the period overload only exists for
+// such types, so period(5) still means 5 seconds. the conversion
+// is integer-only and folds away when the duration is constant.
+// an out-of-range period is clamped, like value() does
+// ------------------------------------------------------------
+template <uint8_t N>
+template <class Duration>
+auto PITimerChannel<N>::period(const Duration& newPeriod) -> decltype(void(Duration::period::den)) {
+  myValue = checkedValue(PITimerRatio<typename Duration::period>::cycles(newPeriod.count()));
+  writeValue();
+}
+
+template <uint8_t N>
+template <class Duration>
+Duration PITimerChannel<N>::remains() {
+  return Duration(typename Duration::rep(PITimerRatio<typename Duration::period>::count(current())));
+}
+
+
+
+// ------------------------------------------------------------
+// returns the amount of time (in ns or us) until the timer
+// will fire next, rounded to the nearest whole unit
+// ------------------------------------------------------------
+template <uint8_t N>
+uint64_t PITimerChannel<N>::remainsNanos() {
+  return PITimerNanos::time(current());
+}
+
+template <uint8_t N>
+uint32_t PITimerChannel<N>::remainsMicros() {
+  return PITimerMicros::time(current());
+}
+
+
+
+// ------------------------------------------------------------
+// returns true if the timer has fired but its ISR hasn't run
+// yet (i.e. the flag is still set). only really meaningful with
+// interrupts disabled, or with the timer's interrupt masked
+// ------------------------------------------------------------
+template <uint8_t N>
+inline bool PITimerChannel<N>::expired() {
+  wake();
+  return tflg();
+}
+
+
+
+// ------------------------------------------------------------
+// throws away an expiry that hasn't been serviced yet. the flag
+// and the pending interrupt are both cleared, so the callback
+// won't run for it and it isn't counted
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::discard() {
+  wake();
+  tflg() = 1;
+  NVIC_CLEAR_PENDING(irq);
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of bus cycles this timer has been running
+// for, as a 64-bit count that never wraps (in practice) and
+// never goes backwards. it combines the completed periods with
+// the progress of the current countdown, read from CVAL. the
+// read is lock-free: if the ISR runs in the middle of it, mySeq
+// changes and it's simply repeated. if the timer has already
+// expired but its ISR hasn't run yet (because interrupts are
+// disabled, or we're in a higher priority ISR), the flag is
+// still set, so that period is added here instead, using a fresh
+// read of CVAL in case the reload happened after the first read.
+// the count only advances while the timer is running, and not
+// when it was started with trigger()
+// ------------------------------------------------------------
+template <uint8_t N>
+uint64_t PITimerChannel<N>::now() {
+  wake();
+  for (;;) {
+    uint32_t seq = mySeq;
+    PITIMER_BARRIER();
+    uint64_t cycles = myCycles;
+    uint32_t loaded = myLoaded;
+    if (tctrl() & 2) {
+      uint32_t current = cval();
+      if (tflg()) {
+        current = cval();
+        cycles += uint64_t(loaded) + 1;
+        loaded = myValue;
+      }
+      cycles += loaded - current;
+    }
+    PITIMER_BARRIER();
+    if (seq == mySeq) return cycles;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// same as above, in nanoseconds (good for 584 years)
+// ------------------------------------------------------------
+template <uint8_t N>
+uint64_t PITimerChannel<N>::nowNanos() {
+  return PITimerNanos::time(now());
+}
+
+
+
+#if PITIMER_PROFILE
+// ------------------------------------------------------------
+// returns a copy of the ISR measurements for this channel (see
+// PITimerProfile.h). the ISR marks its updates with an odd
+// myProfileSeq, and the copy is simply taken again if an update
+// came along while it was being made, so the ISR is never held
+// up. meant to be called from loop(), or at least from code that
+// can't interrupt this channel's ISR
+// ------------------------------------------------------------
+template <uint8_t N>
+PITimerProfile PITimerChannel<N>::profile() {
+  PITimerProfile snapshot;
+  for (;;) {
+    uint32_t seq = myProfileSeq;
+    PITIMER_BARRIER();
+    snapshot = myProfile;
+    PITIMER_BARRIER();
+    if (!(seq & 1) && seq == myProfileSeq) return snapshot;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// throws away the ISR measurements for this channel
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerChannel<N>::profileZero() {
+  PITimerLock lock;
+  myProfile.latency.zero();
+  myProfile.duration.zero();
+}
+#endif
+
+
+
+// ------------------------------------------------------------
+// the body of the ISR (Interrupt Service Routine) for this
+// channel, called by pit0_isr() and friends in PITimer.cpp
+// (through dispatch(), once start() has installed it).
+// it auto-clears the flag, queues up the next dithered period
+// if there is one, posts an event if the timer has a queue, and
+// then runs the user's callback. at this point myCycles is the
+// exact time the timer expired, which is used as the timestamp.
+// if the flag is set again by the time the callback returns,
+// that's an overrun, and it's dealt with as set by overrun().
+// a one-shot timer is stopped before its callback runs, and the
+// time up to that point counts towards now().
+// with PITIMER_PROFILE, CVAL is also read on the way in and out.
+// the countdown started from myLoaded when the timer expired, so
+// the first read gives the entry latency. both reads are turned
+// into (the low 32 bits of) the same timeline as now(), so the
+// duration stays right even if the callback calls reset() or
+// changes the period. a one-shot timer that's left stopped has no
+// countdown to time its callback with, so only its latency is
+// recorded. all of this adds a few dozen cycles
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerChannel<N>::isr() {
+#if PITIMER_PROFILE
+  uint32_t entry = cval();
+#endif
+  clear();
+  if (isDithering) dither();
+#if PITIMER_PROFILE
+  uint32_t latency = myLoaded - entry;
+  uint32_t started = uint32_t(myCycles) + latency;
+#endif
+  if (isOneShot) {
+    account();
+    tctrl() = 0;
+    isRunning = false;
+  }
+  if (myQueue) myQueue->post(N, myCount, myCycles);
+  myCallback();
+#if PITIMER_PROFILE
+  uint32_t finished = uint32_t(myCycles) + myLoaded - cval();
+  if (tflg()) finished = uint32_t(myCycles) + myLoaded + 1 + myValue - cval();
+  myProfileSeq++;
+  PITIMER_BARRIER();
+  myProfile.latency.record(latency);
+  if (tctrl() & 1) myProfile.duration.record(finished - started);
+  PITIMER_BARRIER();
+  myProfileSeq++;
+#endif
+  if (tflg()) {
+    myOverruns++;
+    if (myPolicy == PITIMER_SKIP) skip();
+    myOverrunHandler();
+  }
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERCHRONO_H__
+#define __PITIMERCHRONO_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+#include <chrono>
+
+
+
+// ------------------------------------------------------------
+// a std::chrono duration counted in bus cycles, the native unit
+// of every timer. durations in any other unit convert to it (and
+// back) with std::chrono::duration_cast, with the ratio to F_BUS
+// worked out at compile time
+// ------------------------------------------------------------
+typedef std::chrono::duration<int64_t, std::ratio<1, F_BUS> > PITimerCycles;
+
+
+
+// ------------------------------------------------------------
+// a std::chrono clock running off a timer's now() (see
+// PITimerChannel.h), so it's exact to the bus cycle and never
+// wraps. it's steady, but only moves while the timer is running
+// ------------------------------------------------------------
+template <uint8_t N>
+class PITimerClock {
+  public:
+    typedef PITimerCycles duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<PITimerClock> time_point;
+    static constexpr bool is_steady = true;
+    static time_point now() {
+      return time_point(duration(PITimerChannel<N>::now()));
+    }
+};
+
+template <uint8_t N>
+constexpr bool PITimerClock<N>::is_steady;
+
+
+
+// ------------------------------------------------------------
+// converts a duration to a timer value at compile time, for use
+// with value(). unlike period(duration), which clamps whatever it
+// gets, this refuses to compile if the duration is out of range
+// when it's used in a constant expression, e.g.
+//   constexpr uint32_t tick = PITimerValue(std::chrono::microseconds(50));
+// ------------------------------------------------------------
+template <class Rep, class Period>
+constexpr uint32_t PITimerValue(const std::chrono::duration<Rep, Period>& newPeriod) {
+  return PITimerMath::checkedValue(PITimerRatio<Period>::cycles(newPeriod.count()));
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,118 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERCONFIG_H__
+#define __PITIMERCONFIG_H__
+
+
+
+// ------------------------------------------------------------
+// compile-time options for the library. each can be changed
+// here, or overridden by defining it before this file is
+// included (e.g. with -D on the compiler command line)
+// ------------------------------------------------------------
+
+
+
+// ------------------------------------------------------------
+// define PITIMER_SIM (for the whole build, e.g. -DPITIMER_SIM)
+// to build the library for a PC instead of the Teensy, on top of
+// the simulated chip in PITimerSim.h. it's off unless defined
+// ------------------------------------------------------------
+//#define PITIMER_SIM
+
+
+
+// ------------------------------------------------------------
+// size of the inline buffer (in 32-bit words) that holds
+// the captures of a lambda or functor passed to start().
+// larger captures are rejected at compile time
+// ------------------------------------------------------------
+#ifndef PITIMER_CALLBACK_WORDS
+#define PITIMER_CALLBACK_WORDS 3
+#endif
+
+
+
+// ------------------------------------------------------------
+// number of levels in a PITimerWheel. each level has 64 slots,
+// so four levels reach 2^24 ticks (about 16 s with 1 us ticks)
+// before a deadline has to be re-filed. each level costs 64
+// pointers of RAM per wheel
+// ------------------------------------------------------------
+#ifndef PITIMER_WHEEL_LEVELS
+#define PITIMER_WHEEL_LEVELS 4
+#endif
+
+
+
+// ------------------------------------------------------------
+// set to 1 to have every channel's ISR measure its own entry
+// latency and the time taken by its callback (see profile() in
+// PITimerChannel.h). when it's 0, none of that code is compiled.
+// this has to be changed here rather than from a sketch, so that
+// the library and the sketch agree on it. the histograms have
+// PITIMER_PROFILE_BUCKETS buckets, each 2^PITIMER_PROFILE_SHIFT
+// bus cycles wide, and the last one also counts everything longer
+// ------------------------------------------------------------
+#ifndef PITIMER_PROFILE
+#define PITIMER_PROFILE 0
+#endif
+
+#ifndef PITIMER_PROFILE_BUCKETS
+#define PITIMER_PROFILE_BUCKETS 16
+#endif
+
+#ifndef PITIMER_PROFILE_SHIFT
+#define PITIMER_PROFILE_SHIFT 4
+#endif
+
+
+
+// ------------------------------------------------------------
+// set PITIMER_SAMPLER to 1 to turn one channel into a sampling
+// profiler for the whole program (see PITimerSampler.h). that
+// channel (PITIMER_SAMPLER_CHANNEL, 0 to 2) then belongs to the
+// sampler, and its PITimer object mustn't be used. the histogram
+// covers the first PITIMER_SAMPLER_SIZE bytes of the address
+// space (all of the flash on a Teensy 3.0), in buckets of
+// 2^PITIMER_SAMPLER_SHIFT bytes, at 2 bytes of RAM per bucket
+// ------------------------------------------------------------
+#ifndef PITIMER_SAMPLER
+#define PITIMER_SAMPLER 0
+#endif
+
+#ifndef PITIMER_SAMPLER_CHANNEL
+#define PITIMER_SAMPLER_CHANNEL 2
+#endif
+
+#ifndef PITIMER_SAMPLER_SIZE
+#define PITIMER_SAMPLER_SIZE 0x20000
+#endif
+
+#ifndef PITIMER_SAMPLER_SHIFT
+#define PITIMER_SAMPLER_SHIFT 8
+#endif
+
+
+
+// ------------------------------------------------------------
+// the largest rounding error, in parts per million, allowed for
+// a literal like 70_kHz (see PITimerLiterals.h). a period has to
+// be a whole number of bus cycles, and a literal that can't get
+// within this of what it says fails to compile
+// ------------------------------------------------------------
+#ifndef PITIMER_LITERAL_PPM
+#define PITIMER_LITERAL_PPM 100
+#endif
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
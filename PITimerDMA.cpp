@@ -0,0 +1,33 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerDMA.h"
+
+
+
+// ------------------------------------------------------------
+// the ISRs of the DMA channels that go with PITimer0-2, which only
+// run when a PITimerDMA has half or full callbacks to call, and of
+// DMA channel 3, which only runs for a PITimerADC. like
+// pit0_isr() and friends, each one jumps to the handler its
+// channel installed, so a PITimerDMA or PITimerADC that's never
+// started doesn't pull its ISR into the image
+// ------------------------------------------------------------
+void dma_ch0_isr() { PITimerDMABase::dispatch(0); }
+void dma_ch1_isr() { PITimerDMABase::dispatch(1); }
+void dma_ch2_isr() { PITimerDMABase::dispatch(2); }
+void dma_ch3_isr() { PITimerDMABase::dispatch(3); }
+
+
+
+// ------------------------------------------------------------
+// the handler each DMA channel installed when it was last started
+// ------------------------------------------------------------
+void (*PITimerDMABase::myHandlers[4])();
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,184 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERDMA_H__
+#define __PITIMERDMA_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// the handlers the DMA channel ISRs jump to (see PITimerDMA.cpp),
+// installed by whatever last enabled the channel's interrupt
+// ------------------------------------------------------------
+class PITimerDMABase {
+  protected:
+    static void (*myHandlers[4])();
+  public:
+    static void dispatch(uint8_t channel) { myHandlers[channel](); }
+};
+
+
+
+// ------------------------------------------------------------
+// moves one element of a buffer to a fixed address (a GPIO port's
+// PDOR, the DAC, etc.) every time PIT channel N expires, using
+// DMA channel N, with no interrupt and no CPU time at all. the
+// DMAMUX only routes PIT triggers to the DMA channel with the same
+// number, and gates an always-enabled request slot with them, so
+// each period starts exactly one transfer. the buffer is played
+// in a loop until stop(). optional callbacks run (from the DMA
+// channel's ISR) when the first half and the whole buffer have
+// gone out, so that one half can be refilled while the other one
+// plays. the rate comes from the PIT channel, set as usual, or
+// with load() to go below the ISR limit of value(). N is 0 to 2:
+// DMA channel 3 belongs to PITimerADC, and PIT channel 3 to tone()
+// ------------------------------------------------------------
+template <uint8_t N>
+class PITimerDMA : public PITimerDMABase {
+  static_assert(N < 3, "PITimerDMA: N must be 0, 1 or 2 (DMA channel 3 is PITimerADC's, PIT channel 3 is tone()'s)");
+  private:
+    static const uint8_t muxEnable = 0x80;
+    static const uint8_t muxTrigger = 0x40;
+    static const uint8_t muxAlways = 54;
+    static const uint16_t csrMajor = 0x0002;
+    static const uint16_t csrHalf = 0x0004;
+    static const uint16_t csrDone = 0x0080;
+    static PITimerCallback myHalf;
+    static PITimerCallback myFull;
+    static PITimerTCD& tcd() { return PIT_DMA_TCD(N); }
+    static void setup(const volatile void* buffer, uint16_t count, volatile void* target, uint8_t size);
+  public:
+    static const uint8_t id = N;
+    static const uint8_t irq = IRQ_DMA_CH0 + N;
+    static const uint16_t countMax = 32767;
+    template <class T>
+    static void start(const T* buffer, uint16_t count, volatile T* target,
+      const PITimerCallback& half = PITimerCallback(), const PITimerCallback& full = PITimerCallback());
+    static void stop();
+    static uint16_t position();
+    static void isr();
+};
+
+
+
+template <uint8_t N> PITimerCallback PITimerDMA<N>::myHalf;
+template <uint8_t N> PITimerCallback PITimerDMA<N>::myFull;
+
+
+
+// ------------------------------------------------------------
+// starts playing count elements of buffer into target, one per
+// period of the PIT channel. the element type picks the transfer
+// size (8, 16 or 32 bits), and count is limited to countMax by
+// the DMA's loop counter. count should be even if the half
+// callback is used. the callbacks are optional: without them, the
+// DMA channel's interrupt stays disabled. the buffer has to stay
+// valid (and in place) until stop() is called
+// ------------------------------------------------------------
+template <uint8_t N>
+template <class T>
+inline void PITimerDMA<N>::start(const T* buffer, uint16_t count, volatile T* target,
+  const PITimerCallback& half, const PITimerCallback& full) {
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4, "PITimerDMA: elements must be 8, 16 or 32 bits");
+  myHalf = half;
+  myFull = full;
+  setup(buffer, count, target, sizeof(T));
+}
+
+
+
+// ------------------------------------------------------------
+// does the actual setup. the source address steps by one element
+// per transfer and is wound back to the start of the buffer at the
+// end of each major loop (the whole buffer), while the target
+// stays put. the DMA request is enabled before the PIT is started,
+// so the very first period already moves the first element
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerDMA<N>::setup(const volatile void* buffer, uint16_t count, volatile void* target, uint8_t size) {
+  if (count > countMax) count = countMax;
+  if (count == 0) count = 1;
+  SIM_SCGC6 |= SIM_SCGC6_DMAMUX;
+  SIM_SCGC7 |= SIM_SCGC7_DMA;
+  PITimerChannel<N>::stop();
+  DMA_CERQ = N;
+  PIT_DMAMUX(N) = 0;
+  uint16_t sizeCode = size >> 1;
+  tcd().saddr = (uintptr_t)buffer;
+  tcd().soff = size;
+  tcd().attr = (sizeCode << 8) | sizeCode;
+  tcd().nbytes = size;
+  tcd().slast = -int32_t(count) * size;
+  tcd().daddr = (uintptr_t)target;
+  tcd().doff = 0;
+  tcd().citer = count;
+  tcd().dlastsga = 0;
+  tcd().biter = count;
+  tcd().csr = (myHalf.empty() ? 0 : csrHalf) | (myFull.empty() ? 0 : csrMajor);
+  PIT_DMAMUX(N) = muxEnable | muxTrigger | (muxAlways + N);
+  if (myHalf.empty() && myFull.empty()) NVIC_DISABLE_IRQ(irq);
+  else {
+    myHandlers[N] = isr;
+    NVIC_ENABLE_IRQ(irq);
+  }
+  DMA_SERQ = N;
+  PITimerChannel<N>::trigger();
+}
+
+
+
+// ------------------------------------------------------------
+// stops the PIT channel and the transfers. the buffer can be
+// reused (or freed) once this returns
+// ------------------------------------------------------------
+template <uint8_t N>
+void PITimerDMA<N>::stop() {
+  PITimerChannel<N>::stop();
+  DMA_CERQ = N;
+  NVIC_DISABLE_IRQ(irq);
+  PIT_DMAMUX(N) = 0;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the index in the buffer of the next element to go out.
+// the DMA's loop counter counts down, from count to 1
+// ------------------------------------------------------------
+template <uint8_t N>
+inline uint16_t PITimerDMA<N>::position() {
+  return tcd().biter - tcd().citer;
+}
+
+
+
+// ------------------------------------------------------------
+// the body of the DMA channel's ISR, installed by setup() for
+// dma_ch0_isr() and friends in PITimerDMA.cpp. the DONE bit tells the end of the
+// buffer apart from its halfway point
+// ------------------------------------------------------------
+template <uint8_t N>
+inline void PITimerDMA<N>::isr() {
+  DMA_CINT = N;
+  if (tcd().csr & csrDone) {
+    DMA_CDNE = N;
+    myFull();
+  }
+  else myHalf();
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerGroup.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// initializer for the PITimerGroup class. a group starts out empty
+// ------------------------------------------------------------
+PITimerGroup::PITimerGroup() : mySize(0), myTimers(), myControls(), myOffsets() {
+}
+
+
+
+// ------------------------------------------------------------
+// adds a timer to the group, with the callback it will run (any
+// of the forms start() accepts) and its offset in bus cycles.
+// returns false if the timer is already in the group, or if the
+// group is full. the timer isn't touched until start()
+// ------------------------------------------------------------
+bool PITimerGroup::add(PITimer& timer, const PITimerCallback& newCallback, uint32_t offset) {
+  if (mySize == sizeMax) return false;
+  for (uint8_t i = 0; i < mySize; i++) {
+    if (myTimers[i]->id() == timer.id()) return false;
+  }
+  myTimers[mySize] = &timer;
+  myControls[mySize] = &PIT_CH(timer.id()).tctrl;
+  myOffsets[mySize] = offset;
+  myCallbacks[mySize] = newCallback;
+  mySize++;
+  return true;
+}
+
+
+
+// ------------------------------------------------------------
+// takes a timer out of the group, without stopping it. returns
+// false if it wasn't in the group
+// ------------------------------------------------------------
+bool PITimerGroup::remove(PITimer& timer) {
+  for (uint8_t i = 0; i < mySize; i++) {
+    if (myTimers[i]->id() != timer.id()) continue;
+    mySize--;
+    for (; i < mySize; i++) {
+      myTimers[i] = myTimers[i + 1];
+      myControls[i] = myControls[i + 1];
+      myOffsets[i] = myOffsets[i + 1];
+      myCallbacks[i] = myCallbacks[i + 1];
+    }
+    return true;
+  }
+  return false;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of timers in the group
+// ------------------------------------------------------------
+uint8_t PITimerGroup::size() {
+  return mySize;
+}
+
+
+
+// ------------------------------------------------------------
+// (re)starts every timer in the group, in phase. the register
+// addresses were worked out in add(), so nothing comes between
+// the TEN writes but the writes themselves. that's why they're
+// unrolled into a switch that falls through, rather than a loop,
+// whose counter and branch would land between them. any timer that
+// was already running is restarted, just as with start()
+// ------------------------------------------------------------
+void PITimerGroup::start() {
+  PITimerLock lock;
+  for (uint8_t i = 0; i < mySize; i++) myTimers[i]->arm(myCallbacks[i], myOffsets[i]);
+  PITimerReg* const* control = myControls;
+  switch (mySize) {
+    case 4: **control++ = 3; // fall through
+    case 3: **control++ = 3; // fall through
+    case 2: **control++ = 3; // fall through
+    case 1: **control = 3;
+  }
+  for (uint8_t i = 0; i < mySize; i++) myTimers[i]->launch();
+}
+
+
+
+// ------------------------------------------------------------
+// stops every timer in the group
+// ------------------------------------------------------------
+void PITimerGroup::stop() {
+  PITimerLock lock;
+  for (uint8_t i = 0; i < mySize; i++) myTimers[i]->stop();
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,54 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERGROUP_H__
+#define __PITIMERGROUP_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// starts several timers together, so that their phases line up.
+// calling start() on each one in turn leaves them dozens of cycles
+// apart (more if an interrupt gets in between), and the gaps are
+// different every time. a group gets everything ready first, with
+// interrupts disabled, and then sets TEN on its timers with a
+// run of back-to-back register writes, so they all start within
+// a few bus cycles of each other, and always the same few. each
+// timer keeps its own period, set beforehand as usual, and can
+// be given an offset: its first period is stretched by that many
+// cycles, so it runs that far behind the others from then on.
+// timers with equal periods can be staggered this way, so that
+// their interrupts don't all come due at once
+// ------------------------------------------------------------
+class PITimerGroup {
+  private:
+    static const uint8_t sizeMax = 4;
+    uint8_t mySize;
+    PITimer* myTimers[sizeMax];
+    PITimerReg* myControls[sizeMax];
+    uint32_t myOffsets[sizeMax];
+    PITimerCallback myCallbacks[sizeMax];
+  public:
+    PITimerGroup();
+    bool add(PITimer& timer, const PITimerCallback& newCallback = PITimerCallback(), uint32_t offset = 0);
+    bool remove(PITimer& timer);
+    uint8_t size();
+    void start();
+    void stop();
+};
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
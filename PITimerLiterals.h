@@ -0,0 +1,166 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERLITERALS_H__
+#define __PITIMERLITERALS_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// user-defined literals for fixed periods and frequencies, e.g.
+//   PITimer0.frequency(2000_Hz);
+//   PITimer1.period(50_us);
+// each one is turned into a timer value (a PITimerConstant) by
+// the compiler, for the F_BUS the sketch is built with, so there's
+// no math left to do at run time. and instead of being clamped
+// like everything else, a literal that's out of range, or that
+// can't be hit to within PITIMER_LITERAL_PPM (see
+// PITimerConfig.h), fails to compile. whole and decimal numbers
+// both work (2.5_kHz, 0.25_s), exponents and hex don't
+// ------------------------------------------------------------
+
+
+
+// ------------------------------------------------------------
+// the digits of a literal, read left to right at compile time:
+// the number as a whole (mantissa), and what it has to be divided
+// by to put the decimal point back (scale). anything that isn't a
+// digit, a single point or a digit separator, or a number too big
+// for 64 bits, makes it invalid
+// ------------------------------------------------------------
+template <bool V, uint64_t M, uint64_t S, bool P, char... C>
+class PITimerDigits {
+  public:
+    static constexpr bool valid = V;
+    static constexpr uint64_t mantissa = M;
+    static constexpr uint64_t scale = S;
+};
+
+template <bool V, uint64_t M, uint64_t S, bool P, char H, char... C>
+class PITimerDigits<V, M, S, P, H, C...> : public PITimerDigits<
+  V && (H >= '0' && H <= '9'
+    ? M <= (UINT64_MAX - 9) / 10 && (!P || S <= UINT64_MAX / 10)
+    : (H == '.' && !P) || H == '\''),
+  H >= '0' && H <= '9' && M <= (UINT64_MAX - 9) / 10 ? M * 10 + (H - '0') : M,
+  H >= '0' && H <= '9' && P && S <= UINT64_MAX / 10 ? S * 10 : S,
+  P || H == '.',
+  C...> {
+};
+
+
+
+// ------------------------------------------------------------
+// a period of Num / Den bus cycles, rounded to the nearest whole
+// cycle and checked. the rounding error is in parts per million
+// ------------------------------------------------------------
+template <bool V, uint64_t Num, uint64_t Den>
+class PITimerLiteral {
+  private:
+    static constexpr uint64_t cycles = Den ? PITimerMath::divRound(Num, Den) : 0;
+    static constexpr uint64_t diff = cycles * Den > Num ? cycles * Den - Num : Num - cycles * Den;
+    static constexpr uint64_t error = !Num ? 0
+      : diff > UINT64_MAX / 1000000 ? diff / (Num / 1000000)
+      : diff * 1000000 / Num;
+    static_assert(V, "PITimer literal: not a plain decimal number, or too many digits");
+    static_assert(Den, "PITimer literal: a frequency can't be 0");
+    static_assert(!Den || cycles >= uint64_t(PITimerMath::valueMin) + 1, "PITimer literal: period too short (or frequency too high)");
+    static_assert(!Den || cycles - 1 <= PITimerMath::valueMax, "PITimer literal: period too long (or frequency too low)");
+    static_assert(error <= PITIMER_LITERAL_PPM, "PITimer literal: not a whole number of bus cycles, to within PITIMER_LITERAL_PPM");
+  public:
+    static constexpr PITimerConstant constant() {
+      return PITimerConstant(uint32_t(cycles - 1));
+    }
+};
+
+
+
+// ------------------------------------------------------------
+// a time in units of 1 / unitsPerSecond seconds is
+// mantissa * F_BUS / (scale * unitsPerSecond) cycles, and a
+// frequency in units of unitsPerSecond hertz is
+// scale * F_BUS / (mantissa * unitsPerSecond) cycles. an invalid
+// literal is given a harmless period, so that the only error is
+// the one that says what's wrong
+// ------------------------------------------------------------
+template <uint64_t unitsPerSecond, char... C>
+class PITimerTimeLiteral {
+  private:
+    typedef PITimerDigits<true, 0, 1, false, C...> Digits;
+    typedef PITimerUnits<unitsPerSecond> Units;
+    static constexpr bool valid = Digits::valid
+      && Digits::mantissa <= UINT64_MAX / 2 / Units::num
+      && Digits::scale <= UINT64_MAX / Units::den;
+  public:
+    typedef PITimerLiteral<valid, valid ? Digits::mantissa * Units::num : F_BUS, valid ? Digits::scale * Units::den : 1> Literal;
+};
+
+template <uint64_t unitsPerSecond, char... C>
+class PITimerFrequencyLiteral {
+  private:
+    typedef PITimerDigits<true, 0, 1, false, C...> Digits;
+    static constexpr uint64_t g = PITimerMath::gcd(F_BUS, unitsPerSecond);
+    static constexpr uint64_t num = F_BUS / g;
+    static constexpr uint64_t den = unitsPerSecond / g;
+    static constexpr bool valid = Digits::valid
+      && Digits::scale <= UINT64_MAX / 2 / num
+      && Digits::mantissa <= UINT64_MAX / den;
+  public:
+    typedef PITimerLiteral<valid, valid ? Digits::scale * num : F_BUS, valid ? Digits::mantissa * den : 1> Literal;
+};
+
+
+
+// ------------------------------------------------------------
+// the literals themselves. they're templates over the characters
+// of the number, which is what lets them check it at compile time
+// ------------------------------------------------------------
+template <char... C>
+constexpr PITimerConstant operator"" _s() {
+  return PITimerTimeLiteral<1, C...>::Literal::constant();
+}
+
+template <char... C>
+constexpr PITimerConstant operator"" _ms() {
+  return PITimerTimeLiteral<1000, C...>::Literal::constant();
+}
+
+template <char... C>
+constexpr PITimerConstant operator"" _us() {
+  return PITimerTimeLiteral<1000000, C...>::Literal::constant();
+}
+
+template <char... C>
+constexpr PITimerConstant operator"" _ns() {
+  return PITimerTimeLiteral<1000000000, C...>::Literal::constant();
+}
+
+template <char... C>
+constexpr PITimerConstant operator"" _Hz() {
+  return PITimerFrequencyLiteral<1, C...>::Literal::constant();
+}
+
+template <char... C>
+constexpr PITimerConstant operator"" _kHz() {
+  return PITimerFrequencyLiteral<1000, C...>::Literal::constant();
+}
+
+template <char... C>
+constexpr PITimerConstant operator"" _MHz() {
+  return PITimerFrequencyLiteral<1000000, C...>::Literal::constant();
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
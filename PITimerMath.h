@@ -0,0 +1,143 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERMATH_H__
+#define __PITIMERMATH_H__
+
+
+
+#include "PITimerPort.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// integer-only conversions between timer values and units of
+// time or frequency. the Teensy 3.0 has no FPU, so the float
+// versions of period() and frequency() go through software
+// division and floor(). everything here is exact rational math
+// on 64-bit integers, rounded half-up to the nearest bus cycle,
+// and drops to a single hardware 32-bit divide whenever the
+// operands fit. the float versions get within a cycle of it, but
+// with 24 bits of precision and arguments that are rarely exact
+// to begin with, they land one off now and then (see
+// extras/tests/Math.cpp). all of it is constexpr, so constant
+// arguments are converted at compile time. checkedValue() is the exception
+// that proves the rule: out of range, it calls valueOutOfRange(),
+// which isn't constexpr, so a period that's out of range in a
+// constant expression won't compile (at run time, it's clamped)
+// ------------------------------------------------------------
+class PITimerMath {
+  public:
+    static const uint16_t valueMin = 639;
+    static const uint32_t valueMax = UINT32_MAX - 1;
+    static constexpr uint64_t gcd(uint64_t a, uint64_t b) {
+      return b ? gcd(b, a % b) : a;
+    }
+    static constexpr uint64_t divRound(uint64_t n, uint64_t d) {
+      return (n + d / 2 <= UINT32_MAX && d <= UINT32_MAX)
+        ? uint32_t(n + d / 2) / uint32_t(d)
+        : (n + d / 2) / d;
+    }
+    static constexpr uint32_t clampValue(uint64_t cycles) {
+      return cycles < uint64_t(valueMin) + 1 ? valueMin
+        : cycles - 1 > valueMax ? valueMax
+        : uint32_t(cycles - 1);
+    }
+    static constexpr uint32_t valueFromTime(uint64_t time, uint64_t num, uint64_t den) {
+      return time > UINT64_MAX / 2 / num ? valueMax : clampValue(divRound(time * num, den));
+    }
+    static constexpr uint32_t valueFromMillihertz(uint32_t mHz) {
+      return mHz == 0 ? valueMax : clampValue(divRound(uint64_t(F_BUS) * 1000, mHz));
+    }
+    static constexpr uint32_t millihertzFromValue(uint32_t value) {
+      return divRound(uint64_t(F_BUS) * 1000, uint64_t(value) + 1);
+    }
+    static uint32_t valueOutOfRange(uint64_t cycles) {
+      return clampValue(cycles);
+    }
+    static constexpr uint32_t checkedValue(uint64_t cycles) {
+      return cycles < uint64_t(valueMin) + 1 || cycles - 1 > valueMax
+        ? valueOutOfRange(cycles)
+        : uint32_t(cycles - 1);
+    }
+};
+
+
+
+// ------------------------------------------------------------
+// the ratio between the bus clock and some unit of time,
+// reduced to lowest terms. at 48 MHz, one microsecond is
+// exactly 48 cycles (48/1) and one nanosecond is 6/125 cycles,
+// which keeps the intermediate products small. time() converts
+// whole multiples of num separately from the remainder, so it
+// never overflows before its result does
+// ------------------------------------------------------------
+template <uint64_t unitsPerSecond>
+class PITimerUnits {
+  public:
+    static constexpr uint64_t num = F_BUS / PITimerMath::gcd(F_BUS, unitsPerSecond);
+    static constexpr uint64_t den = unitsPerSecond / PITimerMath::gcd(F_BUS, unitsPerSecond);
+    static constexpr uint32_t value(uint64_t time) {
+      return PITimerMath::valueFromTime(time, num, den);
+    }
+    static constexpr uint64_t time(uint64_t cycles) {
+      return cycles / num * den + PITimerMath::divRound(cycles % num * den, num);
+    }
+};
+
+typedef PITimerUnits<1000000000> PITimerNanos;
+typedef PITimerUnits<1000000> PITimerMicros;
+
+
+
+// ------------------------------------------------------------
+// the same for anything shaped like a std::chrono::duration: a
+// count() of ticks of Period::num / Period::den seconds each, as
+// in std::ratio. nothing here needs <chrono> itself, so PITimer.h
+// doesn't have to include it (see PITimerChrono.h). negative
+// counts come out as 0 cycles, and huge ones as UINT64_MAX
+// ------------------------------------------------------------
+template <class Period>
+class PITimerRatio {
+  private:
+    static constexpr uint64_t scale = uint64_t(F_BUS) * Period::num;
+  public:
+    static constexpr uint64_t num = scale / PITimerMath::gcd(scale, Period::den);
+    static constexpr uint64_t den = Period::den / PITimerMath::gcd(scale, Period::den);
+    static constexpr uint64_t cycles(int64_t count) {
+      return count <= 0 ? 0
+        : uint64_t(count) > UINT64_MAX / 2 / num ? UINT64_MAX
+        : PITimerMath::divRound(uint64_t(count) * num, den);
+    }
+    static constexpr int64_t count(uint64_t cycles) {
+      return cycles / num * den + PITimerMath::divRound(cycles % num * den, num);
+    }
+};
+
+
+
+// ------------------------------------------------------------
+// a timer value that has already been worked out and checked at
+// compile time, as made by the literals in PITimerLiterals.h
+// (2000_Hz, 50_us, and so on). period() and frequency() take it
+// as it is, with no math and no range validation at run time.
+// it's a type of its own, rather than a plain number, so that it
+// can't be mistaken for a number of seconds or hertz
+// ------------------------------------------------------------
+class PITimerConstant {
+  public:
+    uint32_t value;
+    explicit constexpr PITimerConstant(uint32_t newValue) : value(newValue) {}
+};
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,316 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerMotion.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// integer square root, rounded down. only used when a move is
+// planned, never from the ISR
+// ------------------------------------------------------------
+static uint32_t PITimerMotionSqrt(uint64_t n) {
+  uint64_t root = 0;
+  uint64_t bit = uint64_t(1) << 62;
+  while (bit > n) bit >>= 2;
+  while (bit) {
+    if (n >= root + bit) {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else root >>= 1;
+    bit >>= 2;
+  }
+  return root;
+}
+
+
+
+// ------------------------------------------------------------
+// initializer for the PITimerMotion class. newStep runs once per
+// step, and newDirection (if given) whenever a move starts. the
+// motor starts out at position 0, with a top speed and an
+// acceleration of 1000 (steps per second, and per second squared)
+// ------------------------------------------------------------
+PITimerMotion::PITimerMotion(PITimer& timer, const PITimerCallback& newStep, const PITimerCallback& newDirection) :
+  myTimer(timer), myStep(newStep), myDirection(newDirection), mySpeed(1000), myAcceleration(1000),
+  myMinDelay(0), myRampMax(0), myPosition(0), myTarget(0), mySteps(0), myTotal(0), isMoving(false),
+  isForward(true), myState(accelerating), myIndex(0), myDecelStart(0), myDecelCount(0),
+  myAccelCount(0), myDelay(0), myRest(0) {
+}
+
+
+
+// ------------------------------------------------------------
+// the top speed, in steps per second. the period of a step can't
+// go below the timer's own minimum (about 75,000 steps per second
+// at 48 MHz), so anything faster is limited to that. a change
+// only applies from the next move on
+// ------------------------------------------------------------
+void PITimerMotion::speed(uint32_t stepsPerSecond) {
+  mySpeed = stepsPerSecond ? stepsPerSecond : 1;
+}
+
+uint32_t PITimerMotion::speed() {
+  return mySpeed;
+}
+
+
+
+// ------------------------------------------------------------
+// the acceleration (and deceleration), in steps per second
+// squared. 0 means there's no ramp at all: each move runs at the
+// top speed from its first step to its last. a change only
+// applies from the next move on
+// ------------------------------------------------------------
+void PITimerMotion::acceleration(uint32_t stepsPerSecondSquared) {
+  myAcceleration = stepsPerSecondSquared;
+}
+
+uint32_t PITimerMotion::acceleration() {
+  return myAcceleration;
+}
+
+
+
+// ------------------------------------------------------------
+// works out the shape of a move of myTotal steps. the first
+// period is 0.676 * F_BUS * sqrt(2 / acceleration) cycles (the
+// 0.676 corrects the error of the approximation on the first
+// step), the shortest one is set by the top speed, and it takes
+// speed^2 / (2 * acceleration) steps to get from one to the
+// other. if the move is too short for that, it's a triangle
+// instead: half of it speeding up and half slowing down
+// ------------------------------------------------------------
+void PITimerMotion::plan() {
+  uint32_t shortest = F_BUS / mySpeed;
+  myMinDelay = shortest > PITimerMath::valueMin ? shortest : PITimerMath::valueMin + 1;
+  uint64_t first = myMinDelay;
+  uint64_t rampSteps = 1;
+  if (myAcceleration) {
+    first = uint64_t(F_BUS) * 676 / 1000 * PITimerMotionSqrt(2000000000000ULL / myAcceleration) / 1000000;
+    rampSteps = uint64_t(mySpeed) * mySpeed / (2 * uint64_t(myAcceleration));
+    if (rampSteps == 0) rampSteps = 1;
+  }
+  if (first > 0x1FFFFFFF) first = 0x1FFFFFFF;
+  myRampMax = rampSteps < myTotal ? rampSteps : myTotal;
+  uint32_t half = myTotal / 2;
+  myDecelCount = rampSteps < half ? -int32_t(rampSteps) : -int32_t(myTotal - half);
+  myDecelStart = myTotal + myDecelCount;
+  myIndex = 0;
+  myAccelCount = 0;
+  myRest = 0;
+  if (first <= myMinDelay) {
+    myDelay = myMinDelay;
+    myState = cruising;
+  }
+  else {
+    myDelay = first;
+    myState = accelerating;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// one step of Austin's recurrence, c = c - 2c / (4n + 1), with
+// the remainder carried over so that the rounding errors don't
+// add up. n counts up from 1 while speeding up, and from minus
+// the length of the ramp up to 0 while slowing down, which
+// turns the same formula into a deceleration
+// ------------------------------------------------------------
+inline void PITimerMotion::ramp() {
+  int32_t numerator = 2 * myDelay + myRest;
+  int32_t denominator = 4 * myAccelCount + 1;
+  myDelay -= numerator / denominator;
+  myRest = numerator % denominator;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the period (in bus cycles) between step myIndex and the
+// one after it, and moves the profile on by one step. this is
+// what runs in the ISR, and it's the same handful of operations
+// every time, whatever the length of the move
+// ------------------------------------------------------------
+uint32_t PITimerMotion::next() {
+  myIndex++;
+  switch (myState) {
+    case accelerating:
+      myAccelCount++;
+      ramp();
+      if (myIndex >= myDecelStart) {
+        myAccelCount = myDecelCount;
+        myState = decelerating;
+      }
+      else if (myDelay <= int32_t(myMinDelay)) {
+        myDelay = myMinDelay;
+        myRest = 0;
+        myState = cruising;
+      }
+      break;
+    case cruising:
+      if (myIndex >= myDecelStart) {
+        myAccelCount = myDecelCount;
+        myState = decelerating;
+      }
+      break;
+    case decelerating:
+      if (++myAccelCount < 0) ramp();
+      break;
+  }
+  return myDelay;
+}
+
+
+
+// ------------------------------------------------------------
+// runs from the timer's ISR, once per step. the countdown for the
+// step after this one is already under way, so the period loaded
+// here is the one for the step after that. load() skips the
+// range checks of value(), which plan() has already taken care of
+// ------------------------------------------------------------
+void PITimerMotion::tick() {
+  myStep();
+  myPosition += isForward ? 1 : -1;
+  if (++mySteps >= myTotal) {
+    myTimer.stop();
+    isMoving = false;
+    return;
+  }
+  myTimer.load(next() - 1);
+}
+
+
+
+// ------------------------------------------------------------
+// starts a move to the given absolute position. a move that's
+// already under way is cut short first, without slowing down, so
+// it's best to wait for moving() to be false, or to stop() first
+// ------------------------------------------------------------
+void PITimerMotion::moveTo(int32_t newTarget) {
+  PITimerLock lock;
+  if (isMoving) halt();
+  myTarget = newTarget;
+  if (newTarget == myPosition) return;
+  isForward = newTarget > myPosition;
+  myTotal = isForward ? uint32_t(newTarget) - uint32_t(myPosition) : uint32_t(myPosition) - uint32_t(newTarget);
+  mySteps = 0;
+  plan();
+  myDirection();
+  isMoving = true;
+  myTimer.value(myDelay - 1);
+  myTimer.start(PITimerCallback::bind<PITimerMotion, &PITimerMotion::tick>(*this));
+  myTimer.load(next() - 1);
+}
+
+
+
+// ------------------------------------------------------------
+// same as above, relative to the current position
+// ------------------------------------------------------------
+void PITimerMotion::move(int32_t distance) {
+  moveTo(myPosition + distance);
+}
+
+
+
+// ------------------------------------------------------------
+// slows down to a stop as quickly as the acceleration allows,
+// which moves the target to wherever that happens to be. a move
+// that's already slowing down, or would stop sooner anyway, is
+// left alone
+// ------------------------------------------------------------
+void PITimerMotion::stop() {
+  PITimerLock lock;
+  if (!isMoving || myState == decelerating) return;
+  int32_t rampSteps = myState == accelerating ? myAccelCount : int32_t(myRampMax);
+  if (rampSteps < 1) rampSteps = 1;
+  uint32_t total = myIndex + rampSteps;
+  if (total >= myTotal) return;
+  myAccelCount = -rampSteps;
+  myState = decelerating;
+  myTotal = total;
+  myTarget = myPosition + (isForward ? int32_t(total - mySteps) : -int32_t(total - mySteps));
+}
+
+
+
+// ------------------------------------------------------------
+// stops dead, right away. the target becomes the current position
+// ------------------------------------------------------------
+void PITimerMotion::halt() {
+  PITimerLock lock;
+  myTimer.stop();
+  isMoving = false;
+  myTarget = myPosition;
+}
+
+
+
+// ------------------------------------------------------------
+// halts, and then calls the current position something else
+// (after homing, for instance)
+// ------------------------------------------------------------
+void PITimerMotion::position(int32_t newPosition) {
+  PITimerLock lock;
+  halt();
+  myPosition = newPosition;
+  myTarget = newPosition;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the current position, in steps
+// ------------------------------------------------------------
+int32_t PITimerMotion::position() {
+  return myPosition;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the position the current (or last) move ends at
+// ------------------------------------------------------------
+int32_t PITimerMotion::target() {
+  return myTarget;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of steps taken so far in the current (or
+// last) move
+// ------------------------------------------------------------
+uint32_t PITimerMotion::steps() {
+  return mySteps;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if a move is under way
+// ------------------------------------------------------------
+bool PITimerMotion::moving() {
+  return isMoving;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see which way the current (or last) move goes, for
+// setting the driver's DIR pin
+// ------------------------------------------------------------
+bool PITimerMotion::forward() {
+  return isForward;
+}
+
+
+
+// EOF
\ No newline at end of file
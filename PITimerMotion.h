@@ -0,0 +1,81 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERMOTION_H__
+#define __PITIMERMOTION_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// drives a stepper motor from one PIT channel, with a trapezoidal
+// speed profile: it accelerates from rest up to speed(), cruises,
+// and slows down again so as to stop exactly on the target. each
+// expiry of the timer is one step: the step callback runs (to
+// pulse the driver's STEP pin) and the next period is loaded.
+// the ramp uses David Austin's integer approximation, so nothing
+// is precomputed and there's no float or square root in the ISR,
+// just one divide per step while the speed is changing. the PIT
+// only picks up a new period when it expires, so the period is
+// always worked out one step ahead. the direction callback runs
+// when a move starts, before its first step, with forward() set
+// ------------------------------------------------------------
+class PITimerMotion {
+  private:
+    enum State { accelerating, cruising, decelerating };
+    PITimer& myTimer;
+    PITimerCallback myStep;
+    PITimerCallback myDirection;
+    uint32_t mySpeed;
+    uint32_t myAcceleration;
+    uint32_t myMinDelay;
+    uint32_t myRampMax;
+    volatile int32_t myPosition;
+    volatile int32_t myTarget;
+    volatile uint32_t mySteps;
+    volatile uint32_t myTotal;
+    volatile bool isMoving;
+    bool isForward;
+    State myState;
+    uint32_t myIndex;
+    uint32_t myDecelStart;
+    int32_t myDecelCount;
+    int32_t myAccelCount;
+    int32_t myDelay;
+    int32_t myRest;
+    void plan();
+    void ramp();
+    uint32_t next();
+    void tick();
+  public:
+    PITimerMotion(PITimer& timer, const PITimerCallback& newStep, const PITimerCallback& newDirection = PITimerCallback());
+    void speed(uint32_t stepsPerSecond);
+    void acceleration(uint32_t stepsPerSecondSquared);
+    uint32_t speed();
+    uint32_t acceleration();
+    void moveTo(int32_t newTarget);
+    void move(int32_t distance);
+    void stop();
+    void halt();
+    void position(int32_t newPosition);
+    int32_t position();
+    int32_t target();
+    uint32_t steps();
+    bool moving();
+    bool forward();
+};
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERPORT_H__
+#define __PITIMERPORT_H__
+
+
+
+#include "PITimerConfig.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// the distance between the register blocks of two PIT channels
+// (PITimerChannelRegs, below, lays out one block)
+// ------------------------------------------------------------
+#define PITIMER_CH_STRIDE 0x10
+
+
+
+// ------------------------------------------------------------
+// keeps the compiler from moving memory accesses across it
+// ------------------------------------------------------------
+#define PITIMER_BARRIER() __asm__ volatile ("" ::: "memory")
+
+
+
+#ifdef PITIMER_SIM
+#include "PITimerSim.h"
+#else
+#include <mk20dx128.h>
+
+
+
+// ------------------------------------------------------------
+// the four PIT channels each own a block of four registers,
+// laid out at a fixed 0x10 stride starting at PIT_LDVAL0.
+// everything the library touches is addressed relative to
+// PITIMER_CH_BASE, so with a constant channel number every
+// access folds down to a single load or store at a literal
+// address. to run the library off-target, build it with
+// PITIMER_SIM instead (see PITimerSim.h)
+// ------------------------------------------------------------
+#define PITIMER_CH_BASE 0x40037100
+
+typedef volatile uint32_t PITimerReg;
+
+#define PIT_CH(n) (((PITimerChannelRegs*)(uintptr_t)PITIMER_CH_BASE)[n])
+
+
+
+// ------------------------------------------------------------
+// the DMA transfer control descriptors (one 32-byte TCD per DMA
+// channel) and the DMAMUX channel configuration bytes. the PIT
+// channels can only trigger the DMA channels with the same number,
+// so these are addressed the same way as the PIT registers above
+// ------------------------------------------------------------
+#define PITIMER_DMA_TCD_BASE 0x40009000
+#define PITIMER_DMAMUX_BASE 0x40021000
+
+struct PITimerTCD {
+  volatile uint32_t saddr;
+  volatile int16_t soff;
+  volatile uint16_t attr;
+  volatile uint32_t nbytes;
+  volatile int32_t slast;
+  volatile uint32_t daddr;
+  volatile int16_t doff;
+  volatile uint16_t citer;
+  volatile int32_t dlastsga;
+  volatile uint16_t csr;
+  volatile uint16_t biter;
+};
+
+#define PIT_DMA_TCD(n) (*(PITimerTCD*)(uintptr_t)(PITIMER_DMA_TCD_BASE + (n) * sizeof(PITimerTCD)))
+#define PIT_DMAMUX(n) (*(volatile uint8_t*)(uintptr_t)(PITIMER_DMAMUX_BASE + (n)))
+
+
+
+// ------------------------------------------------------------
+// the core's SysTick registers (SysTick runs millis()) and the
+// interrupt control register, for the few that mk20dx128.h
+// might not have, plus WFI, which sleeps until an interrupt is
+// pending. with interrupts disabled it still wakes up, it just
+// doesn't run the ISR until they're enabled again
+// ------------------------------------------------------------
+#ifndef SYST_CSR
+#define SYST_CSR (*(volatile uint32_t*)0xE000E010)
+#endif
+
+#ifndef SYST_RVR
+#define SYST_RVR (*(volatile uint32_t*)0xE000E014)
+#endif
+
+#ifndef SYST_CVR
+#define SYST_CVR (*(volatile uint32_t*)0xE000E018)
+#endif
+
+#ifndef SCB_ICSR
+#define SCB_ICSR (*(volatile uint32_t*)0xE000ED04)
+#endif
+
+#define PITIMER_WFI() __asm__ volatile ("wfi" ::: "memory")
+
+extern "C" volatile uint32_t systick_millis_count;
+
+
+
+// ------------------------------------------------------------
+// disables interrupts for as long as it's in scope, then puts
+// them back the way they were. safe to nest, and safe to use
+// from inside an ISR
+// ------------------------------------------------------------
+class PITimerLock {
+  private:
+    uint32_t myMask;
+  public:
+    PITimerLock() {
+      __asm__ volatile ("mrs %0, primask" : "=r" (myMask));
+      __disable_irq();
+    }
+    ~PITimerLock() {
+      if (!myMask) __enable_irq();
+    }
+};
+
+
+
+#endif
+
+
+
+// ------------------------------------------------------------
+// one PIT channel's block of registers, overlaid on the chip by
+// PIT_CH(n). the channels sit one after another, so PIT_CH(n) is
+// just the n-th element of an array starting at PITIMER_CH_BASE.
+// with a constant n that's a literal address, and with a runtime
+// one (a PITimer's id(), say) it's one shift and add, with no
+// table of pointers to keep around
+// ------------------------------------------------------------
+struct PITimerChannelRegs {
+  PITimerReg ldval;
+  PITimerReg cval;
+  PITimerReg tctrl;
+  PITimerReg tflg;
+};
+
+static_assert(sizeof(PITimerChannelRegs) == PITIMER_CH_STRIDE, "PITimerChannelRegs doesn't match the PIT's layout");
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
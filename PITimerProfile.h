@@ -0,0 +1,85 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERPROFILE_H__
+#define __PITIMERPROFILE_H__
+
+
+
+#include "PITimerConfig.h"
+#include <stdint.h>
+#include <string.h>
+
+
+
+// ------------------------------------------------------------
+// running statistics for one measurement, in bus cycles: the
+// number of samples, their minimum, maximum and mean, and a
+// histogram with fixed-width buckets (see PITimerConfig.h)
+// ------------------------------------------------------------
+class PITimerStats {
+  private:
+    uint32_t mySamples;
+    uint32_t myMin;
+    uint32_t myMax;
+    uint64_t myTotal;
+    uint32_t myBuckets[PITIMER_PROFILE_BUCKETS];
+  public:
+    static const uint8_t buckets = PITIMER_PROFILE_BUCKETS;
+    static const uint32_t bucketWidth = uint32_t(1) << PITIMER_PROFILE_SHIFT;
+    void record(uint32_t cycles);
+    void zero();
+    uint32_t samples() const { return mySamples; }
+    uint32_t min() const { return myMin; }
+    uint32_t max() const { return myMax; }
+    uint32_t mean() const { return mySamples ? myTotal / mySamples : 0; }
+    uint32_t bucket(uint8_t index) const { return index < buckets ? myBuckets[index] : 0; }
+};
+
+
+
+// ------------------------------------------------------------
+// the two measurements kept for each channel. latency is the
+// time from the timer expiring to its ISR starting, and duration
+// is the time taken by the callback (plus the ISR's own upkeep)
+// ------------------------------------------------------------
+class PITimerProfile {
+  public:
+    PITimerStats latency;
+    PITimerStats duration;
+};
+
+
+
+// ------------------------------------------------------------
+// adds one sample. this runs in the ISR, so it's kept to a few
+// compares, one 64-bit add and one increment in the histogram
+// ------------------------------------------------------------
+inline void PITimerStats::record(uint32_t cycles) {
+  if (cycles < myMin || !mySamples) myMin = cycles;
+  if (cycles > myMax) myMax = cycles;
+  mySamples++;
+  myTotal += cycles;
+  uint32_t index = cycles >> PITIMER_PROFILE_SHIFT;
+  myBuckets[index < buckets ? index : buckets - 1]++;
+}
+
+
+
+// ------------------------------------------------------------
+// throws away all samples
+// ------------------------------------------------------------
+inline void PITimerStats::zero() {
+  memset(this, 0, sizeof(*this));
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
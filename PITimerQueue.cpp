@@ -0,0 +1,69 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerQueue.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// initializer for the PITimerQueueBase class. size is already
+// known to be a power of two (see PITimerQueue<N>)
+// ------------------------------------------------------------
+PITimerQueueBase::PITimerQueueBase(PITimerEvent* events, uint16_t size) :
+  myEvents(events), myMask(size - 1), myHead(0), myTail(0), myDropped(0) {
+}
+
+
+
+// ------------------------------------------------------------
+// takes the oldest event off the queue, from loop(). returns
+// false if there isn't one
+// ------------------------------------------------------------
+bool PITimerQueueBase::poll(PITimerEvent& event) {
+  return poll(&event, 1) == 1;
+}
+
+
+
+// ------------------------------------------------------------
+// takes up to maxEvents events off the queue in one go, oldest
+// first, and returns how many there were. the tail index is only
+// moved once they've all been copied out, which frees their slots
+// for the ISR
+// ------------------------------------------------------------
+uint16_t PITimerQueueBase::poll(PITimerEvent* events, uint16_t maxEvents) {
+  uint16_t tail = myTail;
+  uint16_t ready = myHead - tail;
+  if (ready > maxEvents) ready = maxEvents;
+  PITIMER_BARRIER();
+  for (uint16_t i = 0; i < ready; i++) events[i] = myEvents[(tail + i) & myMask];
+  PITIMER_BARRIER();
+  myTail = tail + ready;
+  return ready;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of events waiting to be polled
+// ------------------------------------------------------------
+uint16_t PITimerQueueBase::available() {
+  return myHead - myTail;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of events dropped because the queue was full
+// ------------------------------------------------------------
+uint32_t PITimerQueueBase::dropped() {
+  return myDropped;
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERQUEUE_H__
+#define __PITIMERQUEUE_H__
+
+
+
+#include "PITimerPort.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// what a timer posts to its queue each time it fires: which
+// timer it was, its count() after firing, and when it expired,
+// as the low 32 bits of its now() (in bus cycles). the timestamp
+// is exact, no matter how late the ISR ran
+// ------------------------------------------------------------
+class PITimerEvent {
+  public:
+    uint8_t id;
+    uint32_t count;
+    uint32_t timestamp;
+};
+
+
+
+// ------------------------------------------------------------
+// a lock-free ring buffer of events, for moving work out of the
+// timer's ISR and into loop(). the ISR is the only producer and
+// loop() the only consumer, so the two sides never touch the same
+// index and nothing has to be locked: each side writes the data
+// first and then publishes it by moving its own index. if the
+// queue is full, the new event is dropped and counted rather
+// than overwriting one that hasn't been read yet. several timers
+// can share a queue as long as their ISRs can't interrupt each
+// other (which they can't at the default, equal, priority).
+// the storage comes from PITimerQueue<N>, below
+// ------------------------------------------------------------
+class PITimerQueueBase {
+  private:
+    PITimerEvent* myEvents;
+    uint16_t myMask;
+    volatile uint16_t myHead;
+    volatile uint16_t myTail;
+    volatile uint32_t myDropped;
+  protected:
+    PITimerQueueBase(PITimerEvent* events, uint16_t size);
+  public:
+    bool post(uint8_t id, uint32_t count, uint32_t timestamp);
+    bool poll(PITimerEvent& event);
+    uint16_t poll(PITimerEvent* events, uint16_t maxEvents);
+    uint16_t available();
+    uint32_t dropped();
+};
+
+
+
+// ------------------------------------------------------------
+// a queue with room for N events. N has to be a power of two,
+// so that the indexes wrap with a mask instead of a divide
+// ------------------------------------------------------------
+template <uint16_t N>
+class PITimerQueue : public PITimerQueueBase {
+  private:
+    PITimerEvent myStorage[N];
+  public:
+    PITimerQueue() : PITimerQueueBase(myStorage, N) {
+      static_assert(N && !(N & (N - 1)) && N <= 32768, "PITimerQueue: size must be a power of two, up to 32768");
+    }
+};
+
+
+
+// ------------------------------------------------------------
+// adds an event, from the ISR. the head index is only moved once
+// the event is fully written, so loop() never sees half of one
+// ------------------------------------------------------------
+inline bool PITimerQueueBase::post(uint8_t id, uint32_t count, uint32_t timestamp) {
+  uint16_t head = myHead;
+  if (uint16_t(head - myTail) > myMask) {
+    myDropped++;
+    return false;
+  }
+  PITimerEvent& event = myEvents[head & myMask];
+  event.id = id;
+  event.count = count;
+  event.timestamp = timestamp;
+  PITIMER_BARRIER();
+  myHead = head + 1;
+  return true;
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,175 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerSampler.h"
+#include <stdint.h>
+#include <string.h>
+
+
+
+#if PITIMER_SAMPLER
+
+
+
+#define PITIMER_SAMPLER_PASTE(a, b, c) a ## b ## c
+#define PITIMER_SAMPLER_NAME(a, b, c) PITIMER_SAMPLER_PASTE(a, b, c)
+#define PITIMER_SAMPLER_ISR PITIMER_SAMPLER_NAME(pit, PITIMER_SAMPLER_CHANNEL, _isr)
+
+
+
+uint16_t PITimerSampler::myCounts[PITimerSampler::buckets];
+volatile uint32_t PITimerSampler::mySamples;
+volatile uint32_t PITimerSampler::myOutside;
+volatile uint8_t PITimerSampler::myScale;
+
+
+
+// ------------------------------------------------------------
+// the sampler channel's ISR. on the way in, the core pushes r0-r3,
+// r12, lr, pc and xPSR onto whichever stack was in use (bit 2 of
+// the EXC_RETURN value in lr says which), so the interrupted PC
+// is 24 bytes up from that stack pointer. the stub fetches it
+// and jumps (rather than calls) to PITimerSamplerRecord(), which
+// returns from the interrupt for it. in the simulation, there's
+// no stack frame, and the PC is whatever PITimerSim::pc is set to
+// ------------------------------------------------------------
+extern "C" void PITimerSamplerRecord(uint32_t pc) {
+  PITimerSampler::record(pc);
+}
+
+#ifdef PITIMER_SIM
+void PITIMER_SAMPLER_ISR() {
+  PITimerSamplerRecord(PITimerSim::pc);
+}
+#else
+void __attribute__((naked)) PITIMER_SAMPLER_ISR() {
+  __asm__ volatile (
+    "tst lr, #4\n"
+    "ite eq\n"
+    "mrseq r0, msp\n"
+    "mrsne r0, psp\n"
+    "ldr r0, [r0, #24]\n"
+    "b PITimerSamplerRecord\n"
+  );
+}
+#endif
+
+
+
+// ------------------------------------------------------------
+// starts sampling, at the given rate in millihertz, adding to
+// whatever has been counted so far
+// ------------------------------------------------------------
+void PITimerSampler::start(uint32_t frequencyMillihertz) {
+  Channel::frequencyMillihertz(frequencyMillihertz);
+  Channel::start();
+}
+
+
+
+// ------------------------------------------------------------
+// stops sampling. the counts are kept
+// ------------------------------------------------------------
+void PITimerSampler::stop() {
+  Channel::stop();
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if the sampler is running
+// ------------------------------------------------------------
+bool PITimerSampler::running() {
+  return Channel::running();
+}
+
+
+
+// ------------------------------------------------------------
+// throws away everything counted so far
+// ------------------------------------------------------------
+void PITimerSampler::zero() {
+  PITimerLock lock;
+  memset(myCounts, 0, sizeof(myCounts));
+  mySamples = 0;
+  myOutside = 0;
+  myScale = 0;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of samples taken since the last zero()
+// ------------------------------------------------------------
+uint32_t PITimerSampler::samples() {
+  return mySamples;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the count for PCs outside of the histogram's range
+// (code running from RAM, for instance)
+// ------------------------------------------------------------
+uint32_t PITimerSampler::outside() {
+  return myOutside;
+}
+
+
+
+// ------------------------------------------------------------
+// returns how many times the counts have been halved, so each
+// one stands for 2^scale() samples
+// ------------------------------------------------------------
+uint8_t PITimerSampler::scale() {
+  return myScale;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the count for one bucket, which covers the addresses
+// from base + (index << shift) up to the next bucket
+// ------------------------------------------------------------
+uint16_t PITimerSampler::count(uint16_t index) {
+  return index < buckets ? myCounts[index] : 0;
+}
+
+
+
+// ------------------------------------------------------------
+// counts one sample, from the ISR. this is a shift, a compare
+// and an increment, except when a bucket fills up
+// ------------------------------------------------------------
+void PITimerSampler::record(uint32_t pc) {
+  Channel::clear();
+  uint32_t index = (pc - base) >> shift;
+  if (index >= buckets) myOutside++;
+  else if (++myCounts[index] == UINT16_MAX) halve();
+  mySamples++;
+}
+
+
+
+// ------------------------------------------------------------
+// halves every count, once one of them is about to overflow.
+// this is rare (every 65535 samples at most, which is over a
+// minute at the default rate), but it does take a pass over the
+// whole histogram from inside the ISR
+// ------------------------------------------------------------
+void PITimerSampler::halve() {
+  for (uint16_t i = 0; i < buckets; i++) myCounts[i] >>= 1;
+  myOutside >>= 1;
+  myScale++;
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
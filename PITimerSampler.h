@@ -0,0 +1,110 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERSAMPLER_H__
+#define __PITIMERSAMPLER_H__
+
+
+
+#include "PITimer.h"
+#include "PITimerConfig.h"
+#include <stdint.h>
+
+
+
+#if PITIMER_SAMPLER
+
+
+
+static_assert(PITIMER_SAMPLER_CHANNEL <= 2, "PITIMER_SAMPLER_CHANNEL must be 0 to 2");
+static_assert(PITIMER_SAMPLER_SHIFT >= 2 && (PITIMER_SAMPLER_SIZE >> PITIMER_SAMPLER_SHIFT) <= 16384, "PITimerSampler: too many buckets, raise PITIMER_SAMPLER_SHIFT");
+
+
+
+// ------------------------------------------------------------
+// a statistical profiler: shows where the program spends its time
+// without a debugger. on every period of its channel, the ISR
+// takes the address of the instruction it interrupted (the PC the
+// core stacked on the way in) and counts it in a histogram of
+// address ranges. sampled for long enough, the counts are in
+// proportion to the time spent in each range, loop() and other
+// interrupts alike. the ISR is a small naked stub (in
+// PITimerSampler.cpp), since by the time a normal function's
+// prologue has run, there's no telling where the frame is. the
+// default rate of 997 Hz is prime, so that it doesn't beat with
+// anything the program does at a round rate. a bucket that fills
+// up halves all of them, keeping the proportions (see scale()).
+// dump() writes the histogram in a compact binary form, which
+// extras/PITimerSampler.py turns into a flat profile by function,
+// using the symbols in the sketch's ELF file
+// ------------------------------------------------------------
+class PITimerSampler {
+  private:
+    typedef PITimerChannel<PITIMER_SAMPLER_CHANNEL> Channel;
+    static uint16_t myCounts[];
+    static volatile uint32_t mySamples;
+    static volatile uint32_t myOutside;
+    static volatile uint8_t myScale;
+    static void halve();
+  public:
+    static const uint32_t base = 0;
+    static const uint8_t shift = PITIMER_SAMPLER_SHIFT;
+    static const uint16_t buckets = PITIMER_SAMPLER_SIZE >> PITIMER_SAMPLER_SHIFT;
+    static void start(uint32_t frequencyMillihertz = 997000);
+    static void stop();
+    static bool running();
+    static void zero();
+    static uint32_t samples();
+    static uint32_t outside();
+    static uint8_t scale();
+    static uint16_t count(uint16_t index);
+    static void record(uint32_t pc);
+    template <class Output> static void dump(Output& out);
+};
+
+
+
+// ------------------------------------------------------------
+// writes the histogram to out (Serial, or anything else with a
+// write(const uint8_t*, size_t)), little-endian:
+//   "PCS1"                     4 bytes
+//   shift, scale               1 byte each
+//   entries                    2 bytes
+//   base, samples, outside     4 bytes each
+//   rate (millihertz)          4 bytes
+// followed by entries pairs of (bucket index, count), 2 bytes
+// each, for the buckets that aren't empty. sampling is paused
+// while it's written, so the header and the counts agree
+// ------------------------------------------------------------
+template <class Output>
+void PITimerSampler::dump(Output& out) {
+  bool wasRunning = running();
+  if (wasRunning) stop();
+  uint16_t entries = 0;
+  for (uint16_t i = 0; i < buckets; i++) entries += myCounts[i] != 0;
+  uint32_t words[4] = { base, mySamples, myOutside, Channel::frequencyMillihertz() };
+  uint8_t header[24] = { 'P', 'C', 'S', '1', shift, myScale, uint8_t(entries), uint8_t(entries >> 8) };
+  for (uint8_t i = 0; i < 16; i++) header[8 + i] = words[i / 4] >> (8 * (i % 4));
+  out.write(header, sizeof(header));
+  for (uint16_t i = 0; i < buckets; i++) {
+    if (!myCounts[i]) continue;
+    uint8_t entry[4] = { uint8_t(i), uint8_t(i >> 8), uint8_t(myCounts[i]), uint8_t(myCounts[i] >> 8) };
+    out.write(entry, sizeof(entry));
+  }
+  if (wasRunning) Channel::start();
+}
+
+
+
+#endif
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
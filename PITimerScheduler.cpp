@@ -0,0 +1,237 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerScheduler.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// initializer for the PITimerSchedulerBase class. nothing
+// touches the hardware until begin() is called
+// ------------------------------------------------------------
+PITimerSchedulerBase::PITimerSchedulerBase(PITimer& timer, const PITimerTask* tasks, uint8_t size, uint8_t* order,
+  uint32_t* phases, PITimerRate* rates, volatile uint32_t* posted, uint32_t* done) :
+  myTimer(timer), myTasks(tasks), mySize(size), myOrder(order), myPhases(phases), myRates(rates),
+  myPosted(posted), myDone(done), myRateCount(0), myTicks(0), myMissed(0), isRunning(false), myReport() {
+}
+
+
+
+// ------------------------------------------------------------
+// works out the base tick, sorts the tasks into rates, and fills
+// in the report. the tick is the greatest common divisor of all
+// the periods and phases, so every task falls on a whole tick.
+// the tasks are sorted by period and then by phase (an insertion
+// sort, since tables are short and this only runs in begin()).
+// a set of tasks can all come due on the same tick if and only
+// if each pair can, which is when their phases agree modulo the
+// gcd of their periods. the peak adds up the budgets of every
+// task that can meet a given one, so it's exact when all of them
+// can meet each other (with phases of 0, say), and an upper bound
+// otherwise
+// ------------------------------------------------------------
+void PITimerSchedulerBase::plan() {
+  PITimerScheduleReport& r = myReport;
+  r = PITimerScheduleReport();
+  uint64_t micros = 0;
+  for (uint8_t i = 0; i < mySize; i++) {
+    const PITimerTask& task = myTasks[i];
+    if (!task.period) return;
+    micros = PITimerMath::gcd(micros, task.period);
+    micros = PITimerMath::gcd(micros, task.offset % task.period);
+  }
+  uint64_t cycles = PITimerMath::divRound(micros * PITimerMicros::num, PITimerMicros::den);
+  r.tick = cycles > UINT32_MAX ? UINT32_MAX : cycles;
+  bool tickValid = cycles >= uint64_t(PITimerMath::valueMin) + 1 && cycles - 1 <= PITimerMath::valueMax;
+
+  for (uint8_t i = 0; i < mySize; i++) {
+    const PITimerTask& task = myTasks[i];
+    myPhases[i] = task.offset % task.period / micros;
+    uint8_t j = i;
+    for (; j > 0; j--) {
+      const PITimerTask& other = myTasks[myOrder[j - 1]];
+      if (other.period < task.period) break;
+      if (other.period == task.period && myPhases[myOrder[j - 1]] <= myPhases[i]) break;
+      myOrder[j] = myOrder[j - 1];
+    }
+    myOrder[j] = i;
+  }
+
+  myRateCount = 0;
+  uint64_t hyperperiod = 1;
+  for (uint8_t i = 0; i < mySize; i++) {
+    uint32_t period = myTasks[myOrder[i]].period / micros;
+    if (!myRateCount || myRates[myRateCount - 1].period != period) {
+      PITimerRate& rate = myRates[myRateCount++];
+      rate.period = period;
+      rate.first = i;
+      rate.size = 0;
+      if (hyperperiod <= UINT32_MAX) hyperperiod = hyperperiod / PITimerMath::gcd(hyperperiod, period) * period;
+    }
+    myRates[myRateCount - 1].size++;
+  }
+  r.hyperperiod = hyperperiod > UINT32_MAX ? UINT32_MAX : hyperperiod;
+  r.rates = myRateCount;
+
+  uint64_t isrLoad = 0;
+  uint64_t loopLoad = 0;
+  uint64_t peak = 0;
+  for (uint8_t i = 0; i < mySize; i++) {
+    const PITimerTask& task = myTasks[i];
+    uint64_t periodCycles = uint64_t(task.period / micros) * cycles;
+    uint64_t load = periodCycles ? (uint64_t(task.budget) * 1000000 + periodCycles - 1) / periodCycles : 0;
+    if (task.mode == PITIMER_IN_LOOP) {
+      loopLoad += load;
+      continue;
+    }
+    isrLoad += load;
+    uint64_t meet = 0;
+    for (uint8_t j = 0; j < mySize; j++) {
+      const PITimerTask& other = myTasks[j];
+      if (other.mode == PITIMER_IN_LOOP) continue;
+      uint64_t g = PITimerMath::gcd(task.period / micros, other.period / micros);
+      if (myPhases[i] % g == myPhases[j] % g) meet += other.budget;
+    }
+    if (meet > peak) peak = meet;
+  }
+  r.isrLoad = isrLoad > UINT32_MAX ? UINT32_MAX : isrLoad;
+  r.loopLoad = loopLoad > UINT32_MAX ? UINT32_MAX : loopLoad;
+  r.peak = peak > UINT32_MAX ? UINT32_MAX : peak;
+  r.feasible = tickValid && isrLoad + loopLoad <= 1000000 && peak <= cycles;
+}
+
+
+
+// ------------------------------------------------------------
+// plans the table (see report()) and, if it's feasible, starts
+// the timer at the base tick. the first tick comes one tick after
+// this, and a task with a phase of p ticks first runs on tick p.
+// returns false, with the timer left stopped, if it isn't
+// ------------------------------------------------------------
+bool PITimerSchedulerBase::begin() {
+  end();
+  plan();
+  if (!myReport.feasible) return false;
+  for (uint8_t i = 0; i < mySize; i++) {
+    myPosted[i] = 0;
+    myDone[i] = 0;
+  }
+  for (uint8_t r = 0; r < myRateCount; r++) {
+    PITimerRate& rate = myRates[r];
+    rate.cursor = 0;
+    rate.countdown = myPhases[myOrder[rate.first]] + 1;
+  }
+  myTicks = 0;
+  myMissed = 0;
+  myTimer.value(myReport.tick - 1);
+  myTimer.start(PITimerCallback::bind<PITimerSchedulerBase, &PITimerSchedulerBase::tick>(*this));
+  isRunning = true;
+  return true;
+}
+
+
+
+// ------------------------------------------------------------
+// stops the timer. loop tasks that were already flagged still
+// run at the next run()
+// ------------------------------------------------------------
+void PITimerSchedulerBase::end() {
+  if (isRunning) myTimer.stop();
+  isRunning = false;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if the scheduler is running
+// ------------------------------------------------------------
+bool PITimerSchedulerBase::running() {
+  return isRunning;
+}
+
+
+
+// ------------------------------------------------------------
+// the scheduler's ISR, once per tick. every rate whose countdown
+// runs out has its next task (and any others at the same phase)
+// due: ISR tasks run there and then, and loop tasks are flagged.
+// the countdown is then set to the next phase in the rate, or, if
+// that was the last one, to the first phase of the next period.
+// rates are sorted fastest first, so the fast tasks go first
+// ------------------------------------------------------------
+void PITimerSchedulerBase::tick() {
+  myTicks++;
+  for (uint8_t r = 0; r < myRateCount; r++) {
+    PITimerRate& rate = myRates[r];
+    if (--rate.countdown) continue;
+    uint8_t* order = myOrder + rate.first;
+    uint32_t phase = myPhases[order[rate.cursor]];
+    do {
+      uint8_t task = order[rate.cursor];
+      if (myTasks[task].mode == PITIMER_IN_LOOP) myPosted[task]++;
+      else myTasks[task].callback();
+      if (++rate.cursor == rate.size) rate.cursor = 0;
+    } while (rate.cursor && myPhases[order[rate.cursor]] == phase);
+    uint32_t next = myPhases[order[rate.cursor]];
+    rate.countdown = rate.cursor ? next - phase : rate.period - phase + next;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// runs the loop tasks that have been flagged since the last
+// call, fastest rate first, from loop(). returns how many ran
+// ------------------------------------------------------------
+uint8_t PITimerSchedulerBase::run() {
+  uint8_t ran = 0;
+  for (uint8_t i = 0; i < mySize; i++) {
+    uint8_t task = myOrder[i];
+    if (myTasks[task].mode != PITIMER_IN_LOOP) continue;
+    uint32_t posted = myPosted[task];
+    uint32_t due = posted - myDone[task];
+    if (!due) continue;
+    myMissed += due - 1;
+    myDone[task] = posted;
+    myTasks[task].callback();
+    ran++;
+  }
+  return ran;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of ticks since begin()
+// ------------------------------------------------------------
+uint32_t PITimerSchedulerBase::ticks() {
+  return myTicks;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of loop task runs that were dropped because
+// the task was flagged again before run() got to it
+// ------------------------------------------------------------
+uint32_t PITimerSchedulerBase::missed() {
+  return myMissed;
+}
+
+
+
+// ------------------------------------------------------------
+// returns what begin() worked out about the table of tasks (see
+// PITimerScheduleReport). it's all zero before begin()
+// ------------------------------------------------------------
+const PITimerScheduleReport& PITimerSchedulerBase::report() {
+  return myReport;
+}
+
+
+
+// EOF
\ No newline at end of file
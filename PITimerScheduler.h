@@ -0,0 +1,165 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERSCHEDULER_H__
+#define __PITIMERSCHEDULER_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// where a task runs: straight from the scheduler's ISR, or from
+// loop(), the next time it calls run()
+// ------------------------------------------------------------
+enum PITimerTaskMode {
+  PITIMER_IN_ISR,
+  PITIMER_IN_LOOP
+};
+
+
+
+// ------------------------------------------------------------
+// one entry in a scheduler's table of tasks: what to run, how
+// often and at what phase (both in microseconds), where to run
+// it, and how long it can take (in bus cycles, for the report;
+// 0 if unknown). everything but the callback and the period can
+// be left out of the table, for a phase of 0, run in the ISR
+//   const PITimerTask tasks[] = {
+//     { control, 1000 },
+//     { filter, 10000, 500 },
+//     { logger, 100000, 0, PITIMER_IN_LOOP },
+//   };
+// ------------------------------------------------------------
+class PITimerTask {
+  public:
+    PITimerCallback callback;
+    uint32_t period;
+    uint32_t offset;
+    PITimerTaskMode mode;
+    uint32_t budget;
+};
+
+
+
+// ------------------------------------------------------------
+// what begin() works out about a table of tasks: the base tick
+// (the length of one interrupt period, in bus cycles), how many
+// ticks it takes for the whole pattern to repeat (saturating at
+// UINT32_MAX), the number of distinct rates, the share of the CPU
+// the tasks take in the ISR and in loop() (in parts per million,
+// from their budgets), and the most the ISR tasks can add up to
+// on any one tick (in bus cycles). that last one is exact when
+// the tasks' phases are all 0, and an upper bound otherwise.
+// the table is feasible if the tick is one the PIT can do, the
+// two loads add up to no more than the whole CPU, and the busiest
+// tick fits within the tick
+// ------------------------------------------------------------
+class PITimerScheduleReport {
+  public:
+    uint32_t tick;
+    uint32_t hyperperiod;
+    uint8_t rates;
+    uint32_t isrLoad;
+    uint32_t loopLoad;
+    uint32_t peak;
+    bool feasible;
+};
+
+
+
+// ------------------------------------------------------------
+// the tasks of one rate (period) in a scheduler, in order of
+// phase, and how many ticks are left until the next of them
+// ------------------------------------------------------------
+class PITimerRate {
+  public:
+    uint32_t period;
+    uint32_t countdown;
+    uint8_t first;
+    uint8_t size;
+    uint8_t cursor;
+};
+
+
+
+// ------------------------------------------------------------
+// a cooperative multi-rate scheduler on one PIT channel, for the
+// classic mix of 1 kHz, 100 Hz and 10 Hz loops that would
+// otherwise take a channel each. begin() takes the greatest
+// common divisor of every period and phase as the base tick, so
+// the timer interrupts at one fixed rate, and sorts the tasks into
+// groups of the same period (rates), fastest first. each rate
+// counts down to its next task, so a tick costs one decrement per
+// rate, plus whatever is due, however many tasks there are. tasks
+// marked PITIMER_IN_LOOP are only flagged by the ISR, and run()
+// (called from loop()) runs the flagged ones. a loop task flagged
+// again before it got to run only runs once, and the runs it
+// missed are counted. tasks never preempt each other. the storage
+// comes from PITimerScheduler<N>, below
+// ------------------------------------------------------------
+class PITimerSchedulerBase {
+  private:
+    PITimer& myTimer;
+    const PITimerTask* myTasks;
+    uint8_t mySize;
+    uint8_t* myOrder;
+    uint32_t* myPhases;
+    PITimerRate* myRates;
+    volatile uint32_t* myPosted;
+    uint32_t* myDone;
+    uint8_t myRateCount;
+    volatile uint32_t myTicks;
+    uint32_t myMissed;
+    bool isRunning;
+    PITimerScheduleReport myReport;
+    void plan();
+    void tick();
+  protected:
+    PITimerSchedulerBase(PITimer& timer, const PITimerTask* tasks, uint8_t size, uint8_t* order,
+      uint32_t* phases, PITimerRate* rates, volatile uint32_t* posted, uint32_t* done);
+  public:
+    bool begin();
+    void end();
+    bool running();
+    uint8_t run();
+    uint32_t ticks();
+    uint32_t missed();
+    const PITimerScheduleReport& report();
+};
+
+
+
+// ------------------------------------------------------------
+// a scheduler for a table of N tasks (see PITimerTask), e.g.
+//   PITimerScheduler<3> scheduler(PITimer0, tasks);
+// the table isn't copied, so it has to outlive the scheduler
+// ------------------------------------------------------------
+template <uint8_t N>
+class PITimerScheduler : public PITimerSchedulerBase {
+  private:
+    uint8_t myOrderStorage[N];
+    uint32_t myPhaseStorage[N];
+    PITimerRate myRateStorage[N];
+    volatile uint32_t myPostedStorage[N];
+    uint32_t myDoneStorage[N];
+  public:
+    PITimerScheduler(PITimer& timer, const PITimerTask (&tasks)[N]) :
+      PITimerSchedulerBase(timer, tasks, N, myOrderStorage, myPhaseStorage, myRateStorage, myPostedStorage, myDoneStorage) {
+      static_assert(N > 0, "PITimerScheduler: needs at least one task");
+    }
+};
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,448 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerPort.h"
+
+
+
+#ifdef PITIMER_SIM
+
+
+
+#include <stdint.h>
+#include <string.h>
+
+
+
+// ------------------------------------------------------------
+// the state of the simulated chip, all zero to begin with
+// ------------------------------------------------------------
+static uint16_t PITimerSimSilence(uint8_t) { return 0; }
+
+PITimerSimReg PITimerSim::pit[4][4];
+PITimerSimReg PITimerSim::mcr;
+PITimerSimReg PITimerSim::scgc6;
+PITimerSimReg PITimerSim::scgc7;
+PITimerSimReg PITimerSim::sopt7;
+PITimerSimReg PITimerSim::adcSC1A;
+PITimerSimReg PITimerSim::adcSC2;
+PITimerSimReg PITimerSim::adcRA;
+PITimerSimReg PITimerSim::dmaSERQ;
+PITimerSimReg PITimerSim::dmaCERQ;
+PITimerSimReg PITimerSim::dmaCINT;
+PITimerSimReg PITimerSim::dmaCDNE;
+PITimerSimReg PITimerSim::systCSR;
+PITimerSimReg PITimerSim::systRVR;
+PITimerSimReg PITimerSim::systCVR;
+PITimerSimReg PITimerSim::scbICSR;
+PITimerTCD PITimerSim::tcd[4];
+uint8_t PITimerSim::mux[16];
+uint32_t PITimerSim::primask;
+uint16_t (*PITimerSim::analog)(uint8_t channel) = PITimerSimSilence;
+uint32_t PITimerSim::pc;
+uint8_t PITimerSim::systickPriority = 32;
+uint64_t PITimerSim::myCycles;
+uint32_t PITimerSim::myERQ;
+uint32_t PITimerSim::myINT;
+bool PITimerSim::isInISR;
+bool PITimerSim::myEnabled[irqCount];
+bool PITimerSim::myPending[irqCount];
+uint8_t PITimerSim::myPriority[irqCount];
+uint32_t PITimerSim::myServiced;
+
+
+
+// ------------------------------------------------------------
+// empty handlers for the interrupts the library doesn't define
+// (pit3_isr, for one), the same as the core's unused_isr, and the
+// core's millisecond count with the SysTick handler that drives it
+// ------------------------------------------------------------
+extern "C" {
+  volatile uint32_t systick_millis_count;
+  void __attribute__((weak)) systick_isr(void) { systick_millis_count++; }
+  void __attribute__((weak)) pit0_isr(void) {}
+  void __attribute__((weak)) pit1_isr(void) {}
+  void __attribute__((weak)) pit2_isr(void) {}
+  void __attribute__((weak)) pit3_isr(void) {}
+  void __attribute__((weak)) dma_ch0_isr(void) {}
+  void __attribute__((weak)) dma_ch1_isr(void) {}
+  void __attribute__((weak)) dma_ch2_isr(void) {}
+  void __attribute__((weak)) dma_ch3_isr(void) {}
+}
+
+
+
+// ------------------------------------------------------------
+// puts every register back to 0, disables and un-pends every
+// interrupt (SysTick goes back to the core's priority of 32, and
+// millis() to 0), and winds the clock back to 0. the timers have to be
+// brought up again with begin() afterwards (a channel only brings
+// itself up once, the first time it's used)
+// ------------------------------------------------------------
+void PITimerSim::reset() {
+  memset(pit, 0, sizeof(pit));
+  mcr.myValue = 0;
+  scgc6.myValue = 0;
+  scgc7.myValue = 0;
+  sopt7.myValue = 0;
+  adcSC1A.myValue = 0;
+  adcSC2.myValue = 0;
+  adcRA.myValue = 0;
+  systCSR.myValue = 0;
+  systRVR.myValue = 0;
+  systCVR.myValue = 0;
+  scbICSR.myValue = 0;
+  memset(tcd, 0, sizeof(tcd));
+  memset(mux, 0, sizeof(mux));
+  primask = 0;
+  pc = 0;
+  systickPriority = 32;
+  systick_millis_count = 0;
+  myCycles = 0;
+  myERQ = 0;
+  myINT = 0;
+  isInISR = false;
+  memset(myEnabled, 0, sizeof(myEnabled));
+  memset(myPending, 0, sizeof(myPending));
+  memset(myPriority, 0, sizeof(myPriority));
+  myServiced = 0;
+}
+
+
+
+// ------------------------------------------------------------
+// runs the chip for the given number of bus cycles. stretches
+// where no timer can expire (and SysTick can't interrupt) are
+// skipped in one go, so the cost depends on the number of events
+// rather than on the number of cycles. called from inside an ISR,
+// it stands for the time that ISR spends running: the timers keep
+// counting (and can expire), but other interrupts have to wait
+// until it returns
+// ------------------------------------------------------------
+void PITimerSim::advance(uint64_t cycles) {
+  service();
+  while (cycles) {
+    uint64_t skip = quiet();
+    if (skip > cycles) skip = cycles;
+    if (skip) {
+      myCycles += skip;
+      cycles -= skip;
+      count(skip * cpuPerBus);
+      if (!(mcr & 2)) {
+        for (uint8_t ch = 0; ch < 4; ch++) {
+          if (pit[ch][2] & 1) pit[ch][1].myValue -= skip;
+        }
+      }
+      continue;
+    }
+    step();
+    cycles--;
+    service();
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// the core waiting for an interrupt: the clock runs on until one
+// is pending, even with interrupts disabled (which is how WFI is
+// meant to be used), or until one has run, if they're enabled.
+// returns straight away if nothing is counting that could ever
+// wake it up
+// ------------------------------------------------------------
+void PITimerSim::wfi() {
+  uint32_t serviced = myServiced;
+  while (myServiced == serviced && !waiting()) {
+    uint64_t wait = quiet();
+    if (wait == UINT64_MAX) return;
+    advance(wait + 1);
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of bus cycles since the last reset()
+// ------------------------------------------------------------
+uint64_t PITimerSim::now() {
+  return myCycles;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if an ISR is running
+// ------------------------------------------------------------
+bool PITimerSim::inISR() {
+  return isInISR;
+}
+
+
+
+// ------------------------------------------------------------
+// the NVIC. an interrupt is pending either because it was set
+// pending, or because its source is still asserted: a PIT flag
+// with TIE set, or a DMA channel's interrupt request
+// ------------------------------------------------------------
+void PITimerSim::enable(uint8_t irq, bool enabled) {
+  if (irq < irqCount) myEnabled[irq] = enabled;
+}
+
+bool PITimerSim::enabled(uint8_t irq) {
+  return irq < irqCount && myEnabled[irq];
+}
+
+void PITimerSim::pend(uint8_t irq, bool pending) {
+  if (irq < irqCount) myPending[irq] = pending;
+}
+
+bool PITimerSim::pending(uint8_t irq) {
+  if (irq >= irqCount) return false;
+  if (myPending[irq]) return true;
+  if (irq >= IRQ_PIT_CH0 && irq <= IRQ_PIT_CH3) {
+    uint8_t ch = irq - IRQ_PIT_CH0;
+    return (pit[ch][2] & 2) && pit[ch][3];
+  }
+  if (irq <= IRQ_DMA_CH3) return myINT & (1 << irq);
+  return false;
+}
+
+void PITimerSim::priority(uint8_t irq, uint8_t newPriority) {
+  if (irq < irqCount) myPriority[irq] = newPriority;
+}
+
+uint8_t PITimerSim::priority(uint8_t irq) {
+  return irq < irqCount ? myPriority[irq] : 0;
+}
+
+
+
+// ------------------------------------------------------------
+// the side effects of writing to a register. a PIT countdown is
+// only reloaded when TEN goes from 0 to 1, TFLG is cleared by
+// writing 1 to it, and CVAL can't be written at all. the DMA's
+// set/clear registers take a channel number. any write to
+// SysTick's CVR clears it, and ICSR only keeps SysTick's pending
+// bit, set by PENDSTSET and cleared by PENDSTCLR. everything else
+// just stores the value
+// ------------------------------------------------------------
+void PITimerSim::write(PITimerSimReg& reg, uint32_t newValue) {
+  if (&reg >= &pit[0][0] && &reg <= &pit[3][3]) {
+    uint8_t index = &reg - &pit[0][0];
+    uint8_t ch = index / 4;
+    switch (index % 4) {
+      case 1:
+        return;
+      case 2:
+        if ((newValue & 1) && !(reg.myValue & 1)) pit[ch][1].myValue = pit[ch][0].myValue;
+        reg.myValue = newValue & 7;
+        return;
+      case 3:
+        if (newValue & 1) reg.myValue = 0;
+        return;
+    }
+  }
+  else if (&reg == &dmaSERQ) myERQ |= 1 << (newValue & 15);
+  else if (&reg == &dmaCERQ) myERQ &= ~(1 << (newValue & 15));
+  else if (&reg == &dmaCINT) myINT &= ~(1 << (newValue & 15));
+  else if (&reg == &dmaCDNE && (newValue & 15) < 4) tcd[newValue & 15].csr &= ~0x0080;
+  else if (&reg == &systCVR) newValue = 0;
+  else if (&reg == &scbICSR) {
+    if (newValue & 0x02000000) reg.myValue = 0;
+    if (newValue & 0x04000000) reg.myValue = 0x04000000;
+    return;
+  }
+  reg.myValue = newValue;
+}
+
+
+
+// ------------------------------------------------------------
+// returns how many bus cycles can go by before anything happens:
+// a running PIT channel expiring, or SysTick reaching 0 with its
+// interrupt enabled. UINT64_MAX if nothing is counting at all
+// ------------------------------------------------------------
+uint64_t PITimerSim::quiet() {
+  uint64_t quiet = UINT64_MAX;
+  if (!(mcr & 2)) {
+    for (uint8_t ch = 0; ch < 4; ch++) {
+      if ((pit[ch][2] & 1) && pit[ch][1] < quiet) quiet = pit[ch][1];
+    }
+  }
+  if ((systCSR & 3) == 3 && systRVR) {
+    uint64_t cpuCycles = systCVR ? uint32_t(systCVR) : uint64_t(systRVR) + 1;
+    uint64_t busCycles = (cpuCycles + cpuPerBus - 1) / cpuPerBus - 1;
+    if (busCycles < quiet) quiet = busCycles;
+  }
+  return quiet;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if an interrupt is waiting to run, whether or not
+// interrupts are enabled
+// ------------------------------------------------------------
+bool PITimerSim::waiting() {
+  if (scbICSR & 0x04000000) return true;
+  for (uint8_t irq = 0; irq < irqCount; irq++) {
+    if (myEnabled[irq] && pending(irq)) return true;
+  }
+  return false;
+}
+
+
+
+// ------------------------------------------------------------
+// SysTick counting down the given number of core cycles. it
+// counts from RVR down to 0 and reloads on the next cycle, so it
+// reaches 0 every RVR + 1 cycles, and that's when it pends its
+// interrupt (if TICKINT is set). an RVR of 0 stops it at 0
+// ------------------------------------------------------------
+void PITimerSim::count(uint64_t cpuCycles) {
+  if (!(systCSR & 1) || !cpuCycles) return;
+  uint32_t current = systCVR;
+  bool reached = false;
+  if (current) {
+    if (cpuCycles < current) {
+      systCVR.myValue = current - cpuCycles;
+      return;
+    }
+    cpuCycles -= current;
+    systCVR.myValue = 0;
+    reached = true;
+  }
+  uint64_t period = uint64_t(systRVR) + 1;
+  if (systRVR && cpuCycles) {
+    reached = reached || cpuCycles >= period;
+    uint32_t left = cpuCycles % period;
+    systCVR.myValue = left ? uint32_t(period - left) : 0;
+  }
+  if (reached && (systCSR & 2)) scbICSR.myValue = 0x04000000;
+}
+
+
+
+// ------------------------------------------------------------
+// one bus cycle for every running timer: count down, or if the
+// countdown has reached 0, reload it and expire. a timer runs for
+// LDVAL + 1 cycles this way, just like the real thing. SysTick
+// counts the core cycles that go by in the meantime
+// ------------------------------------------------------------
+void PITimerSim::step() {
+  myCycles++;
+  count(cpuPerBus);
+  if (mcr & 2) return;
+  for (uint8_t ch = 0; ch < 4; ch++) {
+    if (!(pit[ch][2] & 1)) continue;
+    if (pit[ch][1] == 0) {
+      pit[ch][1].myValue = pit[ch][0];
+      expire(ch);
+    }
+    else pit[ch][1].myValue--;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// a timer expiring sets its flag, and triggers whatever is
+// listening: ADC0 (via SIM_SOPT7, which then requests DMA on any
+// channel set to the ADC0 source), and the DMA channel with the
+// same number (via its DMAMUX trigger, on an always-on source)
+// ------------------------------------------------------------
+void PITimerSim::expire(uint8_t channel) {
+  pit[channel][3].myValue = 1;
+  if ((sopt7 & 0x80) && (sopt7 & 0x0F) == 4u + channel && (adcSC2 & 0x40) && (adcSC1A & 0x1F) != 0x1F) {
+    adcRA.myValue = analog(adcSC1A & 0x1F);
+    if (adcSC2 & 0x04) {
+      for (uint8_t dma = 0; dma < 4; dma++) {
+        if (mux[dma] == (0x80 | 40)) request(dma);
+      }
+    }
+  }
+  if ((mux[channel] & 0xC0) == 0xC0 && (mux[channel] & 0x3F) >= 54) request(channel);
+}
+
+
+
+// ------------------------------------------------------------
+// a DMA request: one minor loop (NBYTES, in transfers of the
+// source size), then the major loop bookkeeping, with the half
+// and major interrupts and the DONE bit. DREQ stops the channel
+// at the end of the major loop
+// ------------------------------------------------------------
+void PITimerSim::request(uint8_t channel) {
+  if (!(myERQ & (1 << channel))) return;
+  PITimerTCD& t = tcd[channel];
+  uint8_t size = 1 << (t.attr >> 8 & 7);
+  for (uint32_t done = 0; done < t.nbytes; done += size) {
+    memcpy((void*)t.daddr, (const void*)t.saddr, size);
+    t.saddr += t.soff;
+    t.daddr += t.doff;
+  }
+  t.citer--;
+  if (t.citer == t.biter / 2 && (t.csr & 0x0004)) myINT |= 1 << channel;
+  if (t.citer == 0) {
+    t.saddr += t.slast;
+    t.daddr += t.dlastsga;
+    t.citer = t.biter;
+    t.csr |= 0x0080;
+    if (t.csr & 0x0002) myINT |= 1 << channel;
+    if (t.csr & 0x0008) myERQ &= ~(1 << channel);
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// runs the pending interrupts, most urgent (lowest priority
+// number) first, for as long as there are any. SysTick is an
+// exception rather than an IRQ, so it wins a tie. nothing runs
+// while interrupts are disabled, or from inside another ISR
+// ------------------------------------------------------------
+void PITimerSim::service() {
+  while (!isInISR && !primask) {
+    int best = -1;
+    for (uint8_t irq = 0; irq < irqCount; irq++) {
+      if (myEnabled[irq] && pending(irq) && (best < 0 || myPriority[irq] < myPriority[best])) best = irq;
+    }
+    if ((scbICSR & 0x04000000) && (best < 0 || systickPriority <= myPriority[best])) {
+      scbICSR.myValue = 0;
+      myServiced++;
+      isInISR = true;
+      systick_isr();
+      isInISR = false;
+      continue;
+    }
+    if (best < 0) return;
+    myPending[best] = false;
+    myServiced++;
+    void (*handler)(void) = 0;
+    switch (best) {
+      case IRQ_DMA_CH0: handler = dma_ch0_isr; break;
+      case IRQ_DMA_CH1: handler = dma_ch1_isr; break;
+      case IRQ_DMA_CH2: handler = dma_ch2_isr; break;
+      case IRQ_DMA_CH3: handler = dma_ch3_isr; break;
+      case IRQ_PIT_CH0: handler = pit0_isr; break;
+      case IRQ_PIT_CH1: handler = pit1_isr; break;
+      case IRQ_PIT_CH2: handler = pit2_isr; break;
+      case IRQ_PIT_CH3: handler = pit3_isr; break;
+    }
+    if (!handler) continue;
+    isInISR = true;
+    handler();
+    isInISR = false;
+  }
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
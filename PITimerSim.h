@@ -0,0 +1,248 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERSIM_H__
+#define __PITIMERSIM_H__
+
+
+
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// a host-side stand-in for the parts of the Teensy 3.0 the
+// library uses, selected by defining PITIMER_SIM for the whole
+// build (see PITimerConfig.h). PITimerPort.h then includes this
+// instead of mk20dx128.h, and the library (and the sketch or
+// firmware on top of it) builds and runs on a PC as it is.
+// it models the four PIT channels (LDVAL, CVAL, TCTRL, TFLG and
+// the MCR), the NVIC's enables, pending bits and priorities,
+// PRIMASK, the DMA channels and DMAMUX as far as PITimerDMA and
+// PITimerADC use them, ADC0's hardware trigger, SysTick (which
+// counts core cycles, F_CPU / F_BUS of them per bus cycle) and
+// WFI, all run by a virtual bus clock. nothing happens until
+// advance() is called, which moves the clock forward, jumping
+// straight from one event to the next, and calls pit0_isr() and
+// friends whenever an enabled interrupt is pending. so runs are
+// deterministic and can cover millions of periods in a fraction
+// of a second.
+// a few simplifications: interrupts run one at a time, in
+// priority order, and never preempt each other; an interrupt
+// that becomes pending outside of advance() (after the code
+// re-enables interrupts, say) only runs at the next advance();
+// register writes take effect immediately; and SysTick has no
+// COUNTFLAG
+// ------------------------------------------------------------
+
+
+
+#ifndef F_BUS
+#define F_BUS 48000000
+#endif
+
+#ifndef F_CPU
+#define F_CPU 96000000
+#endif
+
+
+
+// ------------------------------------------------------------
+// a simulated register. it reads like a plain uint32_t, but every
+// write goes through PITimerSim::write(), which models the side
+// effects (reloading the countdown when TEN goes from 0 to 1,
+// write-one-to-clear flags, and so on). myValue comes first, so
+// the register's address is also the address of its value, which
+// is what the DMA reads from
+// ------------------------------------------------------------
+class PITimerSimReg {
+  private:
+    friend class PITimerSim;
+    uint32_t myValue;
+  public:
+    operator uint32_t() const { return myValue; }
+    PITimerSimReg& operator=(uint32_t newValue);
+    PITimerSimReg& operator|=(uint32_t bits) { return *this = myValue | bits; }
+    PITimerSimReg& operator&=(uint32_t bits) { return *this = myValue & bits; }
+};
+
+
+
+// ------------------------------------------------------------
+// the same transfer control descriptor as in PITimerPort.h, but
+// with addresses wide enough for a 64-bit host
+// ------------------------------------------------------------
+struct PITimerTCD {
+  uintptr_t saddr;
+  int16_t soff;
+  uint16_t attr;
+  uint32_t nbytes;
+  int32_t slast;
+  uintptr_t daddr;
+  int16_t doff;
+  uint16_t citer;
+  int32_t dlastsga;
+  uint16_t csr;
+  uint16_t biter;
+};
+
+
+
+// ------------------------------------------------------------
+// the simulated chip. it's all static, like the chip itself.
+// reset() puts everything back to how it is at power-up, and
+// clears the clock, so that each test can start from scratch
+// ------------------------------------------------------------
+class PITimerSim {
+  public:
+    static const uint8_t irqCount = 64;
+    static PITimerSimReg pit[4][4];
+    static PITimerSimReg mcr;
+    static PITimerSimReg scgc6;
+    static PITimerSimReg scgc7;
+    static PITimerSimReg sopt7;
+    static PITimerSimReg adcSC1A;
+    static PITimerSimReg adcSC2;
+    static PITimerSimReg adcRA;
+    static PITimerSimReg dmaSERQ;
+    static PITimerSimReg dmaCERQ;
+    static PITimerSimReg dmaCINT;
+    static PITimerSimReg dmaCDNE;
+    static PITimerSimReg systCSR;
+    static PITimerSimReg systRVR;
+    static PITimerSimReg systCVR;
+    static PITimerSimReg scbICSR;
+    static PITimerTCD tcd[4];
+    static uint8_t mux[16];
+    static uint32_t primask;
+    static uint16_t (*analog)(uint8_t channel);
+    static uint32_t pc;
+    static uint8_t systickPriority;
+    static void reset();
+    static void advance(uint64_t cycles);
+    static void wfi();
+    static uint64_t now();
+    static bool inISR();
+    static void enable(uint8_t irq, bool enabled);
+    static bool enabled(uint8_t irq);
+    static void pend(uint8_t irq, bool pending);
+    static bool pending(uint8_t irq);
+    static void priority(uint8_t irq, uint8_t newPriority);
+    static uint8_t priority(uint8_t irq);
+    static void write(PITimerSimReg& reg, uint32_t newValue);
+  private:
+    static uint64_t myCycles;
+    static uint32_t myERQ;
+    static uint32_t myINT;
+    static bool isInISR;
+    static bool myEnabled[irqCount];
+    static bool myPending[irqCount];
+    static uint8_t myPriority[irqCount];
+    static uint32_t myServiced;
+    static const uint32_t cpuPerBus = F_CPU / F_BUS;
+    static uint64_t quiet();
+    static bool waiting();
+    static void count(uint64_t cpuCycles);
+    static void step();
+    static void expire(uint8_t channel);
+    static void request(uint8_t channel);
+    static void service();
+};
+
+
+
+inline PITimerSimReg& PITimerSimReg::operator=(uint32_t newValue) {
+  PITimerSim::write(*this, newValue);
+  return *this;
+}
+
+
+
+// ------------------------------------------------------------
+// what the library needs from mk20dx128.h, pointed at the model
+// ------------------------------------------------------------
+typedef PITimerSimReg PITimerReg;
+
+#define PIT_CH(n) (reinterpret_cast<PITimerChannelRegs&>(PITimerSim::pit[n]))
+#define PIT_DMA_TCD(n) (PITimerSim::tcd[n])
+#define PIT_DMAMUX(n) (PITimerSim::mux[n])
+
+#define PIT_MCR PITimerSim::mcr
+#define SIM_SCGC6 PITimerSim::scgc6
+#define SIM_SCGC6_PIT 0x00800000
+#define SIM_SCGC6_DMAMUX 0x00000002
+#define SIM_SCGC7 PITimerSim::scgc7
+#define SIM_SCGC7_DMA 0x00000002
+#define SIM_SOPT7 PITimerSim::sopt7
+#define ADC0_SC1A PITimerSim::adcSC1A
+#define ADC0_SC2 PITimerSim::adcSC2
+#define ADC0_RA PITimerSim::adcRA
+#define DMA_SERQ PITimerSim::dmaSERQ
+#define DMA_CERQ PITimerSim::dmaCERQ
+#define DMA_CINT PITimerSim::dmaCINT
+#define DMA_CDNE PITimerSim::dmaCDNE
+#define SYST_CSR PITimerSim::systCSR
+#define SYST_RVR PITimerSim::systRVR
+#define SYST_CVR PITimerSim::systCVR
+#define SCB_ICSR PITimerSim::scbICSR
+
+#define IRQ_DMA_CH0 0
+#define IRQ_DMA_CH1 1
+#define IRQ_DMA_CH2 2
+#define IRQ_DMA_CH3 3
+#define IRQ_PIT_CH0 30
+#define IRQ_PIT_CH1 31
+#define IRQ_PIT_CH2 32
+#define IRQ_PIT_CH3 33
+
+#define NVIC_ENABLE_IRQ(n) PITimerSim::enable(n, true)
+#define NVIC_DISABLE_IRQ(n) PITimerSim::enable(n, false)
+#define NVIC_SET_PENDING(n) PITimerSim::pend(n, true)
+#define NVIC_CLEAR_PENDING(n) PITimerSim::pend(n, false)
+#define NVIC_SET_PRIORITY(n, p) PITimerSim::priority(n, p)
+#define NVIC_GET_PRIORITY(n) PITimerSim::priority(n)
+
+#define __disable_irq() (PITimerSim::primask = 1)
+#define __enable_irq() (PITimerSim::primask = 0)
+#define PITIMER_WFI() PITimerSim::wfi()
+
+extern "C" {
+  void pit0_isr(void);
+  void pit1_isr(void);
+  void pit2_isr(void);
+  void pit3_isr(void);
+  void dma_ch0_isr(void);
+  void dma_ch1_isr(void);
+  void dma_ch2_isr(void);
+  void dma_ch3_isr(void);
+  void systick_isr(void);
+  extern volatile uint32_t systick_millis_count;
+}
+
+
+
+// ------------------------------------------------------------
+// same as the real one, but on the simulated PRIMASK
+// ------------------------------------------------------------
+class PITimerLock {
+  private:
+    uint32_t myMask;
+  public:
+    PITimerLock() : myMask(PITimerSim::primask) {
+      __disable_irq();
+    }
+    ~PITimerLock() {
+      if (!myMask) __enable_irq();
+    }
+};
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,200 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERTABLE_H__
+#define __PITIMERTABLE_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// one slot of a PITimerTable: the function to run, when it
+// starts (in bus cycles from the start of the frame), and how
+// long it's allowed to take (in bus cycles, 0 if it doesn't
+// matter). it's only a type, and takes no memory
+// ------------------------------------------------------------
+template <uint32_t Offset, void (*Function)(), uint32_t Budget = 0>
+class PITimerSlot {
+  public:
+    static constexpr uint32_t offset = Offset;
+    static constexpr uint32_t budget = Budget;
+    static constexpr void (*function)() = Function;
+};
+
+
+
+// ------------------------------------------------------------
+// the numbers 0 to N - 1 as a template parameter pack, for
+// building the table's arrays one element per slot
+// ------------------------------------------------------------
+template <uint8_t... I>
+class PITimerIndices {
+};
+
+template <uint8_t N, uint8_t... I>
+class PITimerMakeIndices : public PITimerMakeIndices<N - 1, N - 1, I...> {
+};
+
+template <uint8_t... I>
+class PITimerMakeIndices<0, I...> {
+  public:
+    typedef PITimerIndices<I...> Type;
+};
+
+
+
+// ------------------------------------------------------------
+// a time-triggered schedule, fixed at compile time: a frame of
+// Frame bus cycles, repeated forever, with each slot's function
+// run at its offset into the frame, e.g.
+//   typedef PITimerTable<F_BUS / 1000,
+//     PITimerSlot<0, sample, 4000>,
+//     PITimerSlot<F_BUS / 4000, control, 12000>,
+//     PITimerSlot<F_BUS / 2000, output>
+//   > Schedule;
+//   Schedule::start(PITimer0);
+// the compiler checks that the slots are in order, that none of
+// them starts before the one ahead of it has used up its budget
+// (wrapping around the end of the frame), and that they're far
+// enough apart for the PIT. the time from each slot to the next
+// is worked out ahead of time as a timer value, and the timer
+// interrupts exactly at each slot: its ISR loads the gap after
+// the next slot (the PIT only picks up a new value when it
+// reloads, so it has to be one ahead), and runs the slot. a slot
+// that runs late doesn't move the ones after it, because the
+// PIT keeps counting the frame in hardware. the schedule is all
+// static, so there's only one of each. the timer's first period
+// is the gap from the last slot around to the first, as if the
+// last slot had just run when start() was called
+// ------------------------------------------------------------
+template <uint32_t Frame, class... Slots>
+class PITimerTable {
+  private:
+    static const uint8_t size = sizeof...(Slots);
+    static constexpr uint32_t offsets[sizeof...(Slots)] = { Slots::offset... };
+    static constexpr uint32_t budgets[sizeof...(Slots)] = { Slots::budget... };
+    static constexpr uint32_t gap(uint8_t i) {
+      return i ? offsets[i] - offsets[i - 1] : Frame - offsets[size - 1] + offsets[0];
+    }
+    static constexpr bool ordered(uint8_t i) {
+      return i >= size || ((!i || offsets[i] > offsets[i - 1]) && ordered(i + 1));
+    }
+    static constexpr bool apart(uint8_t i) {
+      return i >= size || (budgets[i ? i - 1 : size - 1] <= gap(i) && apart(i + 1));
+    }
+    static constexpr bool reachable(uint8_t i) {
+      return i >= size || (gap(i) >= uint32_t(PITimerMath::valueMin) + 1 && reachable(i + 1));
+    }
+    template <class Indices>
+    class Values;
+    template <uint8_t... I>
+    class Values<PITimerIndices<I...> > {
+      public:
+        static constexpr uint32_t value[sizeof...(I)] = { (gap(I) - 1)... };
+    };
+    typedef Values<typename PITimerMakeIndices<sizeof...(Slots)>::Type> Gaps;
+    static void (* const myFunctions[sizeof...(Slots)])();
+    static PITimer* myTimer;
+    static uint8_t mySlot;
+    static uint8_t myAhead;
+    static void tick(void*);
+    static_assert(sizeof...(Slots) > 0 && sizeof...(Slots) < 256, "PITimerTable: needs 1 to 255 slots");
+    static_assert(ordered(0) && offsets[size - 1] < Frame, "PITimerTable: slots must be in order of offset, within the frame");
+    static_assert(apart(0), "PITimerTable: a slot starts before the one ahead of it has used up its budget");
+    static_assert(reachable(0), "PITimerTable: two slots are closer together than the PIT allows");
+  public:
+    static void start(PITimer& timer);
+    static void stop();
+    static uint8_t slot();
+};
+
+template <uint32_t Frame, class... Slots>
+constexpr uint32_t PITimerTable<Frame, Slots...>::offsets[sizeof...(Slots)];
+
+template <uint32_t Frame, class... Slots>
+constexpr uint32_t PITimerTable<Frame, Slots...>::budgets[sizeof...(Slots)];
+
+template <uint32_t Frame, class... Slots>
+template <uint8_t... I>
+constexpr uint32_t PITimerTable<Frame, Slots...>::Values<PITimerIndices<I...> >::value[sizeof...(I)];
+
+template <uint32_t Frame, class... Slots>
+void (* const PITimerTable<Frame, Slots...>::myFunctions[sizeof...(Slots)])() = { Slots::function... };
+
+template <uint32_t Frame, class... Slots>
+PITimer* PITimerTable<Frame, Slots...>::myTimer;
+
+template <uint32_t Frame, class... Slots>
+uint8_t PITimerTable<Frame, Slots...>::mySlot;
+
+template <uint32_t Frame, class... Slots>
+uint8_t PITimerTable<Frame, Slots...>::myAhead;
+
+
+
+// ------------------------------------------------------------
+// takes over the timer and starts the schedule. the timer starts
+// with the gap up to the first slot, and the gap after that is
+// loaded straight away, to be picked up when the first slot comes
+// ------------------------------------------------------------
+template <uint32_t Frame, class... Slots>
+void PITimerTable<Frame, Slots...>::start(PITimer& timer) {
+  PITimerLock lock;
+  myTimer = &timer;
+  mySlot = 0;
+  myAhead = 2 % size;
+  timer.load(Gaps::value[0]);
+  timer.start(tick, 0);
+  timer.load(Gaps::value[1 % size]);
+}
+
+
+
+// ------------------------------------------------------------
+// stops the timer, and with it the schedule
+// ------------------------------------------------------------
+template <uint32_t Frame, class... Slots>
+void PITimerTable<Frame, Slots...>::stop() {
+  if (myTimer) myTimer->stop();
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of the slot that runs next
+// ------------------------------------------------------------
+template <uint32_t Frame, class... Slots>
+uint8_t PITimerTable<Frame, Slots...>::slot() {
+  return mySlot;
+}
+
+
+
+// ------------------------------------------------------------
+// the timer's callback, at the start of every slot. the gap
+// after the next slot is loaded before the slot runs, so a slot
+// that runs long can't hold it up
+// ------------------------------------------------------------
+template <uint32_t Frame, class... Slots>
+void PITimerTable<Frame, Slots...>::tick(void*) {
+  uint8_t slot = mySlot;
+  myTimer->load(Gaps::value[myAhead]);
+  if (++myAhead == size) myAhead = 0;
+  if (++mySlot == size) mySlot = 0;
+  myFunctions[slot]();
+}
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
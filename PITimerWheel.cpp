@@ -0,0 +1,498 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerWheel.h"
+#include <stdint.h>
+
+
+
+static_assert(PITIMER_WHEEL_LEVELS >= 1 && PITIMER_WHEEL_LEVELS <= 5, "PITIMER_WHEEL_LEVELS must be 1 to 5");
+
+
+
+// ------------------------------------------------------------
+// a software timer starts out idle, with a callback that does
+// nothing until one is given either here or via callback()
+// ------------------------------------------------------------
+PITimerSoft::PITimerSoft() : myNext(0), myLink(0), myExpiry(0), myNominal(0), myPeriod(0), mySlack(0) {
+}
+
+PITimerSoft::PITimerSoft(const PITimerCallback& newCallback) :
+  myNext(0), myLink(0), myExpiry(0), myNominal(0), myPeriod(0), mySlack(0), myCallback(newCallback) {
+}
+
+
+
+// ------------------------------------------------------------
+// sets the function to run when this timer expires. it's safe
+// to change while the timer is scheduled
+// ------------------------------------------------------------
+void PITimerSoft::callback(const PITimerCallback& newCallback) {
+  PITimerLock lock;
+  myCallback = newCallback;
+}
+
+
+
+// ------------------------------------------------------------
+// how many ticks late the timer is allowed to fire (0 by default).
+// rather than waking up separately for every timer, the wheel
+// moves each deadline to the "roundest" tick within its slack
+// (the one with the most trailing zero bits), so timers whose
+// windows overlap mostly end up on the same tick and are fired
+// by the same interrupt. a periodic timer keeps its own period
+// underneath, so the slack never adds up into drift. keep it
+// below the period. a change applies from the next expiry on
+// ------------------------------------------------------------
+void PITimerSoft::slack(uint32_t ticks) {
+  PITimerLock lock;
+  mySlack = ticks;
+}
+
+uint32_t PITimerSoft::slack() {
+  return mySlack;
+}
+
+
+
+// ------------------------------------------------------------
+// check to see if the timer is currently scheduled
+// ------------------------------------------------------------
+bool PITimerSoft::pending() {
+  return myLink != 0;
+}
+
+
+
+// ------------------------------------------------------------
+// the tick a timer due at "expiry" actually fires at: the one
+// within [expiry, expiry + slack] with the most trailing zero
+// bits. everything below the highest bit that differs between
+// the two ends of the window can be cleared from the later end
+// without leaving the window. this works across the wraparound
+// of the tick count, too
+// ------------------------------------------------------------
+static uint32_t PITimerWheelSlack(uint32_t expiry, uint32_t slack) {
+  uint32_t limit = expiry + slack;
+  uint32_t differ = expiry ^ limit;
+  if (!differ) return expiry;
+  return limit & ~((uint32_t(1) << (31 - __builtin_clz(differ))) - 1);
+}
+
+
+
+// ------------------------------------------------------------
+// initializer for the PITimerWheel class. tickCycles is the
+// length of one tick in bus cycles, which sets both the
+// resolution of the wheel and the unit of schedule() and now().
+// the default is one microsecond. nothing touches the hardware
+// until begin() is called
+// ------------------------------------------------------------
+PITimerWheel::PITimerWheel(PITimer& timer, uint32_t tickCycles) :
+  myTimer(timer), myTickCycles(tickCycles ? tickCycles : 1), myTick(0), myRemainder(0),
+  myProgrammed(0), myDeadline(0), myNext(0), myStarted(0), isRunning(false),
+  isUpdating(false), myOccupied(), mySlots() {
+}
+
+
+
+// ------------------------------------------------------------
+// takes over the timer channel and starts counting ticks from
+// zero. any software timers left over from a previous run are
+// dropped (but not called)
+// ------------------------------------------------------------
+void PITimerWheel::begin() {
+  PITimerLock lock;
+  if (isRunning) myTimer.stop();
+  for (uint8_t level = 0; level < PITIMER_WHEEL_LEVELS; level++) {
+    for (uint8_t slot = 0; slot < slotCount; slot++) {
+      for (PITimerSoft* soft = mySlots[level][slot]; soft; soft = soft->myNext) soft->myLink = 0;
+      mySlots[level][slot] = 0;
+    }
+    myOccupied[level] = 0;
+  }
+  myTick = 0;
+  myRemainder = 0;
+  myNext = 0;
+  isRunning = false;
+  program(0, false, false);
+}
+
+
+
+// ------------------------------------------------------------
+// stops the timer channel. scheduled software timers stay where
+// they are, but nothing fires until begin() is called again
+// ------------------------------------------------------------
+void PITimerWheel::end() {
+  PITimerLock lock;
+  myTimer.stop();
+  isRunning = false;
+}
+
+
+
+// ------------------------------------------------------------
+// schedules a software timer to fire delay ticks from now, and
+// then every period ticks after that (or only once if period is
+// 0). a timer which is already pending is moved. can be called
+// from anywhere, including from inside a callback. delays must
+// be less than 2^31 ticks (about 35 minutes with 1 us ticks)
+// ------------------------------------------------------------
+void PITimerWheel::schedule(PITimerSoft& soft, uint32_t delay, uint32_t period) {
+  PITimerLock lock;
+  if (soft.myLink) unlink(soft);
+  soft.myNominal = (isRunning ? currentTick() : myTick) + delay;
+  soft.myExpiry = PITimerWheelSlack(soft.myNominal, soft.mySlack);
+  soft.myPeriod = period;
+  insert(soft);
+  if (isRunning && !isUpdating && !myTimer.expired()) {
+    uint32_t when;
+    if (nextEvent(when) && int32_t(when - myDeadline) < 0) program(when, true, true);
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// takes a software timer off the wheel, if it's pending. this
+// never touches the hardware: if the timer was the next one due,
+// the PIT just wakes up once for nothing and reprograms itself
+// ------------------------------------------------------------
+void PITimerWheel::cancel(PITimerSoft& soft) {
+  PITimerLock lock;
+  if (soft.myLink) unlink(soft);
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of ticks since begin() was called
+// ------------------------------------------------------------
+uint32_t PITimerWheel::now() {
+  PITimerLock lock;
+  return isRunning ? currentTick() : myTick;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of ticks from now until the wheel next has
+// work to do (0 if that's now), or UINT32_MAX if it's empty or
+// stopped. that's the next deadline, unless the timer due next is
+// still on a higher level, in which case it's the (earlier) tick
+// where it gets moved down. either way, it's when the wheel's
+// timer will next go off, unless that's more than one hop away
+// ------------------------------------------------------------
+uint32_t PITimerWheel::next() {
+  PITimerLock lock;
+  uint32_t when;
+  if (!isRunning || !nextEvent(when)) return UINT32_MAX;
+  int32_t ahead = when - currentTick();
+  return ahead > 0 ? ahead : 0;
+}
+
+
+
+// ------------------------------------------------------------
+// sleeps (WFI) until the next interrupt, for a tickless loop().
+// the wheel's timer only goes off when there's work to do, but
+// the core's SysTick interrupt, which runs millis(), would still
+// wake the CPU every millisecond. so while the CPU is asleep,
+// SysTick keeps counting with its interrupt turned off, and the
+// milliseconds it skipped are added to millis() on the way out,
+// so millis() and micros() come out the same as if it had never
+// stopped, however long the sleep. SysTick reaches 0 once a
+// millisecond, and reloads on the cycle after. the reloads while
+// asleep are the core cycles that went by (counted by the wheel's
+// PIT, which runs from the same clock) less the distance the
+// counter moved, in whole periods, rounded since the reads are a
+// few cycles apart. a 0 read on the way out was one more
+// millisecond, and one read on the way in was one reload too
+// many. around that, a millisecond that comes while the interrupt
+// is being turned off or back on is caught by whether it left the
+// interrupt pending, or made the counter jump up between reads.
+// interrupts stay disabled throughout, so the one that ends the
+// sleep only runs once everything is back in place. to check for
+// work an ISR leaves for loop() without losing it, disable
+// interrupts, check, call this, then enable them again: an
+// interrupt that comes after the check stays pending, and WFI
+// returns at once for a pending interrupt even while they're
+// disabled. with SysTick off, or the wheel stopped, it's a plain WFI
+// ------------------------------------------------------------
+void PITimerWheel::sleep() {
+  PITimerLock lock;
+  uint32_t control = SYST_CSR;
+  if (!isRunning || (control & (systEnable | systTickInt)) != (systEnable | systTickInt)) {
+    PITIMER_WFI();
+    return;
+  }
+  uint32_t period = SYST_RVR + 1;
+  uint32_t missed = 0;
+  uint32_t first = SYST_CVR;
+  SYST_CSR = control & ~systTickInt;
+  uint32_t before = SYST_CVR;
+  uint64_t start = myTimer.now();
+  if (SCB_ICSR & icsrPendSTSet) {
+    SCB_ICSR = icsrPendSTClear;
+    missed++;
+  }
+  else if (before > first || (!before && first)) missed++;
+  PITIMER_WFI();
+  uint32_t after = SYST_CVR;
+  int64_t cycles = int64_t(myTimer.now() - start) * (F_CPU / F_BUS);
+  missed += uint32_t((cycles - before + after + period / 2) / period);
+  missed += !after;
+  missed -= !before;
+  SYST_CSR = control;
+  uint32_t last = SYST_CVR;
+  if (!(SCB_ICSR & icsrPendSTSet) && after && (last > after || !last)) missed++;
+  systick_millis_count += missed;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the number of bus cycles since the countdown was last
+// restarted. the channel's now() already counts every reload,
+// whether its ISR has run or it's still pending, so this is just
+// the difference
+// ------------------------------------------------------------
+uint64_t PITimerWheel::elapsed() {
+  return myTimer.now() - myStarted;
+}
+
+
+
+// ------------------------------------------------------------
+// returns the tick we're currently in (not just the last one
+// that was processed)
+// ------------------------------------------------------------
+uint32_t PITimerWheel::currentTick() {
+  uint64_t cycles = uint64_t(myRemainder) + elapsed();
+  if (cycles >> 32) return myTick + uint32_t(cycles / myTickCycles);
+  return myTick + uint32_t(cycles) / myTickCycles;
+}
+
+
+
+// ------------------------------------------------------------
+// files a software timer in the slot for its expiry. the level
+// is picked by how far away the expiry is (relative to myNext,
+// the first tick that hasn't been processed yet), so that it
+// gets cascaded down into level 0 exactly at the start of the
+// 64-tick block it expires in. anything beyond the top level is
+// filed as far out as possible and re-filed when it gets there
+// ------------------------------------------------------------
+void PITimerWheel::insert(PITimerSoft& soft) {
+  uint32_t delta = soft.myExpiry - myNext;
+  if (int32_t(delta) < 0) {
+    soft.myExpiry = myNext;
+    delta = 0;
+  }
+  uint32_t when = soft.myExpiry;
+  uint8_t level = 0;
+  while (level < PITIMER_WHEEL_LEVELS - 1 && delta >> (slotBits * (level + 1))) level++;
+  if (delta >> (slotBits * PITIMER_WHEEL_LEVELS)) when = myNext + (1UL << (slotBits * PITIMER_WHEEL_LEVELS)) - 1;
+  uint8_t slot = (when >> (slotBits * level)) & slotMask;
+  PITimerSoft** head = &mySlots[level][slot];
+  soft.myNext = *head;
+  if (*head) (*head)->myLink = &soft.myNext;
+  *head = &soft;
+  soft.myLink = head;
+  myOccupied[level] |= uint64_t(1) << slot;
+}
+
+
+
+// ------------------------------------------------------------
+// takes a software timer out of whatever list it's in. if that
+// leaves one of the wheel's slots empty, its occupancy bit is
+// cleared so that nextEvent() doesn't wake up for it
+// ------------------------------------------------------------
+void PITimerWheel::unlink(PITimerSoft& soft) {
+  PITimerSoft** link = soft.myLink;
+  *link = soft.myNext;
+  if (soft.myNext) soft.myNext->myLink = link;
+  soft.myNext = 0;
+  soft.myLink = 0;
+  uintptr_t index = (uintptr_t(link) - uintptr_t(&mySlots[0][0])) / sizeof(PITimerSoft*);
+  if (index < uintptr_t(PITIMER_WHEEL_LEVELS) * slotCount && !*link) {
+    myOccupied[index / slotCount] &= ~(uint64_t(1) << (index % slotCount));
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// empties one slot and re-files each of its timers, which moves
+// them down to a finer level now that they're closer
+// ------------------------------------------------------------
+void PITimerWheel::cascade(uint8_t level, uint8_t slot) {
+  PITimerSoft* soft = mySlots[level][slot];
+  mySlots[level][slot] = 0;
+  myOccupied[level] &= ~(uint64_t(1) << slot);
+  while (soft) {
+    PITimerSoft* next = soft->myNext;
+    insert(*soft);
+    soft = next;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// finds the first tick (at or after myNext) where there's work
+// to do: either a level 0 slot to fire, or an occupied slot on a
+// higher level to cascade. for each level, the slots are rotated
+// so that the bit for the next block comes first, and the first
+// set bit is then the answer for that level. returns false if
+// the wheel is empty
+// ------------------------------------------------------------
+bool PITimerWheel::nextEvent(uint32_t& when) {
+  bool found = false;
+  for (uint8_t level = 0; level < PITIMER_WHEEL_LEVELS; level++) {
+    uint64_t mask = myOccupied[level];
+    if (!mask) continue;
+    uint8_t shift = slotBits * level;
+    uint32_t block = (myNext >> shift) + ((myNext & ((1UL << shift) - 1)) != 0);
+    uint8_t first = block & slotMask;
+    if (first) mask = (mask >> first) | (mask << (slotCount - first));
+    uint32_t tick = (block + __builtin_ctzll(mask)) << shift;
+    if (!found || tick - myNext < when - myNext) when = tick;
+    found = true;
+  }
+  return found;
+}
+
+
+
+// ------------------------------------------------------------
+// does the work due at one tick: cascades any higher levels whose
+// blocks start here, then fires everything in the level 0 slot
+// (with a single level, far-off timers can be parked there too,
+// and those just get re-filed).
+// periodic timers are re-filed before their callback runs, so a
+// callback is free to cancel or reschedule its own timer
+// ------------------------------------------------------------
+void PITimerWheel::process(uint32_t when) {
+  myNext = when;
+  for (uint8_t level = 1; level < PITIMER_WHEEL_LEVELS; level++) {
+    if ((when >> (slotBits * (level - 1))) & slotMask) break;
+    cascade(level, (when >> (slotBits * level)) & slotMask);
+  }
+  uint8_t slot = when & slotMask;
+  PITimerSoft* list = mySlots[0][slot];
+  mySlots[0][slot] = 0;
+  myOccupied[0] &= ~(uint64_t(1) << slot);
+  if (list) list->myLink = &list;
+  myNext = when + 1;
+  while (list) {
+    PITimerSoft* soft = list;
+    unlink(*soft);
+    if (soft->myExpiry != when) {
+      insert(*soft);
+      continue;
+    }
+    if (soft->myPeriod) {
+      soft->myNominal += soft->myPeriod;
+      soft->myExpiry = PITimerWheelSlack(soft->myNominal, soft->mySlack);
+      insert(*soft);
+    }
+    soft->myCallback();
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// restarts the countdown so that the timer fires at tick "when"
+// (or as late as the PIT allows, if there's nothing to wait for
+// or it's too far away). the cycles that went by since the last
+// restart are added to the tick count first, and the ones spent
+// doing the math in between once the countdown has restarted, so
+// none of them are lost. the countdown is restarted once before
+// the new value is set as well: the channel's now() takes a
+// pending reload to have come from the current value, and the
+// fresh countdown is at least valueMin long, so there's no chance
+// of one turning up while it changes. if onlySooner is set,
+// the countdown is left alone unless the new one would end first,
+// so a burst of schedule() calls can't keep pushing it back
+// ------------------------------------------------------------
+void PITimerWheel::program(uint32_t when, bool hasEvent, bool onlySooner) {
+  uint64_t before = isRunning ? elapsed() : 0;
+  uint64_t cycles = myRemainder + before;
+  uint32_t tick = myTick + uint32_t(cycles / myTickCycles);
+  uint32_t remainder = uint32_t(cycles % myTickCycles);
+  uint64_t wait = uint64_t(PITimerMath::valueMax) + 1;
+  if (hasEvent) {
+    int32_t ahead = when - tick;
+    uint64_t needed = ahead > 0 ? uint64_t(ahead) * myTickCycles - remainder : 1;
+    if (needed < wait) wait = needed;
+  }
+  uint32_t value = wait - 1 < PITimerMath::valueMin ? PITimerMath::valueMin : uint32_t(wait - 1);
+  if (onlySooner && value >= myTimer.current()) return;
+  if (isRunning) {
+    myTimer.reset();
+    myTimer.value(value);
+    myTimer.reset();
+    uint64_t started = myTimer.now();
+    remainder += uint32_t(started - myStarted - before);
+    myStarted = started;
+  }
+  else {
+    myTimer.value(value);
+    myTimer.start(PITimerCallback::bind<PITimerWheel, &PITimerWheel::tick>(*this));
+    myStarted = myTimer.now();
+    isRunning = true;
+  }
+  myTick = tick + remainder / myTickCycles;
+  myRemainder = remainder % myTickCycles;
+  myProgrammed = value;
+  myDeadline = myTick + uint32_t((uint64_t(myRemainder) + myProgrammed + 1) / myTickCycles);
+}
+
+
+
+// ------------------------------------------------------------
+// fires everything that's due, then programs the next wakeup.
+// if callbacks ran for so long that more work came due in the
+// meantime, that's handled straight away instead
+// ------------------------------------------------------------
+void PITimerWheel::update() {
+  uint32_t when;
+  for (;;) {
+    uint32_t current = currentTick();
+    while (nextEvent(when) && int32_t(when - current) <= 0) process(when);
+    if (int32_t(current + 1 - myNext) > 0) myNext = current + 1;
+    bool hasEvent = nextEvent(when);
+    if (hasEvent && int32_t(when - currentTick()) <= 0) continue;
+    program(when, hasEvent, false);
+    return;
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// the wheel's callback on the timer channel. by the time it runs,
+// the countdown has already reloaded with the interval that just
+// ended. the PIT can only hold one more expiry than that, so the
+// longest possible period is queued up behind it straight away,
+// before any callbacks run. that way the channel's now() (and
+// with it the wheel's clock) can't lose a reload however long
+// they take, and update() programs the real interval after them
+// ------------------------------------------------------------
+void PITimerWheel::tick() {
+  myTimer.value(PITimerMath::valueMax);
+  isUpdating = true;
+  update();
+  isUpdating = false;
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERWHEEL_H__
+#define __PITIMERWHEEL_H__
+
+
+
+#include "PITimer.h"
+#include "PITimerConfig.h"
+#include <stdint.h>
+
+
+
+// ------------------------------------------------------------
+// a software (virtual) timer, run by a PITimerWheel. it can be
+// one-shot or periodic, and any number of them can share a single
+// PIT channel. the object itself is the storage, so it has to
+// outlive its time on the wheel (globals or statics are easiest).
+// a timer with some slack can fire up to that many ticks late,
+// which lets the wheel batch it with its neighbors (see slack())
+// ------------------------------------------------------------
+class PITimerSoft {
+  private:
+    friend class PITimerWheel;
+    PITimerSoft* myNext;
+    PITimerSoft** myLink;
+    uint32_t myExpiry;
+    uint32_t myNominal;
+    uint32_t myPeriod;
+    uint32_t mySlack;
+    PITimerCallback myCallback;
+  public:
+    PITimerSoft();
+    PITimerSoft(const PITimerCallback& newCallback);
+    void callback(const PITimerCallback& newCallback);
+    void slack(uint32_t ticks);
+    uint32_t slack();
+    bool pending();
+};
+
+
+
+// ------------------------------------------------------------
+// a hierarchical timing wheel on top of one PITimer channel.
+// time is counted in ticks of a fixed number of bus cycles (1 us
+// by default). schedule() and cancel() are O(1): a timer is filed
+// in one of 64 slots on one of PITIMER_WHEEL_LEVELS levels, where
+// each level is 64 times coarser than the one below, and moves
+// down a level as its deadline comes closer. the wheel is
+// tickless: rather than interrupting every tick, the PIT is
+// reprogrammed to go off exactly at the next deadline, found from
+// a 64-bit occupancy mask per level. deadlines further away than
+// the PIT can count (about 89 s at 48 MHz) are reached in several
+// hops. callbacks run in the channel's ISR. with sleep() in
+// loop(), the CPU only wakes up for the wheel's deadlines (and
+// whatever other interrupts are enabled)
+// ------------------------------------------------------------
+class PITimerWheel {
+  private:
+    static const uint8_t slotBits = 6;
+    static const uint8_t slotCount = 1 << slotBits;
+    static const uint8_t slotMask = slotCount - 1;
+    static const uint32_t systEnable = 0x01;
+    static const uint32_t systTickInt = 0x02;
+    static const uint32_t icsrPendSTSet = 0x04000000;
+    static const uint32_t icsrPendSTClear = 0x02000000;
+    PITimer& myTimer;
+    uint32_t myTickCycles;
+    uint32_t myTick;
+    uint32_t myRemainder;
+    uint32_t myProgrammed;
+    uint32_t myDeadline;
+    uint32_t myNext;
+    uint64_t myStarted;
+    bool isRunning;
+    bool isUpdating;
+    uint64_t myOccupied[PITIMER_WHEEL_LEVELS];
+    PITimerSoft* mySlots[PITIMER_WHEEL_LEVELS][slotCount];
+    uint64_t elapsed();
+    uint32_t currentTick();
+    void insert(PITimerSoft& soft);
+    void unlink(PITimerSoft& soft);
+    void cascade(uint8_t level, uint8_t slot);
+    bool nextEvent(uint32_t& when);
+    void process(uint32_t when);
+    void program(uint32_t when, bool hasEvent, bool onlySooner);
+    void update();
+    void tick();
+  public:
+    PITimerWheel(PITimer& timer, uint32_t tickCycles = F_BUS / 1000000);
+    void begin();
+    void end();
+    void schedule(PITimerSoft& soft, uint32_t delay, uint32_t period = 0);
+    void cancel(PITimerSoft& soft);
+    uint32_t now();
+    uint32_t next();
+    void sleep();
+};
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "PITimerADC.h"
+
+// samples A0 at 100 kHz in blocks of 1000, with no interrupt
+// per sample, and prints the average of each block
+const uint16_t blockSize = 1000;
+uint16_t buffer[2 * blockSize];
+PITimerADC adc(PITimer1);
+volatile bool ready;
+
+void blockReady() {
+  // runs from the DMA interrupt, 100 times a second
+  ready = true;
+}
+
+void setup() {
+  Serial.begin(true);
+  PITimer1.load(F_BUS / 100000 - 1); // beyond the 75 kHz ISR limit
+  adc.start(A0, buffer, blockSize, blockReady);
+}
+
+void loop() {
+  if (ready) {
+    ready = false;
+    const uint16_t* block = adc.block();
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < blockSize; i++) total += block[i];
+    Serial.println(total / blockSize);
+  }
+}
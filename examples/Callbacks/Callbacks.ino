@@ -0,0 +1,39 @@
+#include "PITimer.h"
+
+class Blinker {
+  public:
+    Blinker(uint8_t pin) : myPin(pin), myState(false) {}
+    void begin() { pinMode(myPin, OUTPUT); }
+    void toggle() {
+      myState = !myState;
+      digitalWrite(myPin, myState);
+    }
+  private:
+    uint8_t myPin;
+    bool myState;
+};
+
+Blinker led(13);
+volatile uint32_t ticks;
+
+void countTicks(void* context) {
+  // runs 1000 times per second, context points at ticks
+  (*(volatile uint32_t*)context)++;
+}
+
+void setup() {
+  Serial.begin(true);
+  led.begin();
+  PITimer0.period(0.5);
+  PITimer0.start(PITimerCallback::bind<Blinker, &Blinker::toggle>(led)); // member function
+  PITimer1.frequencyMillihertz(1000000);
+  PITimer1.start(countTicks, (void*)&ticks); // function plus context
+  uint32_t every = 5;
+  PITimer2.period(1);
+  PITimer2.start([every] { // lambda with a small capture
+    if (PITimer2.count() % every == 0) Serial.println(ticks);
+  });
+}
+
+void loop() {
+}
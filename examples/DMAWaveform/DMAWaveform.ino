@@ -0,0 +1,31 @@
+#include "PITimerDMA.h"
+
+// an 8-step pattern, written to the lower 8 bits of port D
+// (pins 2, 14, 7, 8, 6, 20, 21 and 5) at 1 MHz, with no CPU time.
+// each half is refilled from the callbacks while the other plays
+uint8_t pattern[8];
+uint8_t step;
+
+void fill(uint8_t* half) {
+  for (int i = 0; i < 4; i++) half[i] = 1 << (step++ & 7);
+}
+
+void firstHalfDone() {
+  fill(pattern);
+}
+
+void secondHalfDone() {
+  fill(pattern + 4);
+}
+
+void setup() {
+  const uint8_t pins[8] = {2, 14, 7, 8, 6, 20, 21, 5};
+  for (int i = 0; i < 8; i++) pinMode(pins[i], OUTPUT);
+  fill(pattern);
+  fill(pattern + 4);
+  PITimer0.load(F_BUS / 1000000 - 1); // 1 MHz, well above the ISR limit
+  PITimerDMA<0>::start(pattern, 8, (volatile uint8_t*)&GPIOD_PDOR, firstHalfDone, secondHalfDone);
+}
+
+void loop() {
+}
@@ -0,0 +1,28 @@
+#include "PITimer.h"
+
+// debounces a button on pin 2 with a one-shot timer. every edge
+// pushes the timeout back out, so the callback only runs once
+// the pin has been quiet for 20 ms
+const uint8_t buttonPin = 2;
+volatile bool pressed;
+
+void settled() {
+  pressed = !digitalReadFast(buttonPin);
+  Serial.println(pressed ? "pressed" : "released");
+}
+
+void edge() {
+  PITimer1.retrigger();
+}
+
+void setup() {
+  Serial.begin(true);
+  pinMode(buttonPin, INPUT_PULLUP);
+  PITimer1.periodMicros(20000);
+  PITimer1.once(settled);
+  PITimer1.stop(); // nothing to wait for until the first edge
+  attachInterrupt(buttonPin, edge, CHANGE);
+}
+
+void loop() {
+}
@@ -0,0 +1,28 @@
+#include "PITimer.h"
+
+// the timers only post events here, and all of the printing
+// is done from loop(), outside of the interrupts
+PITimerQueue<32> events;
+
+void setup() {
+  Serial.begin(true);
+  PITimer1.period(0.5);
+  PITimer0.queue(&events);
+  PITimer1.queue(&events);
+  PITimer0.start(); // 1 second
+  PITimer1.start(); // half a second
+}
+
+void loop() {
+  PITimerEvent batch[8];
+  uint16_t n = events.poll(batch, 8);
+  for (uint16_t i = 0; i < n; i++) {
+    Serial.print("Timer ");
+    Serial.print(batch[i].id);
+    Serial.print(" fired (");
+    Serial.print(batch[i].count);
+    Serial.print(") at cycle ");
+    Serial.println(batch[i].timestamp);
+  }
+  if (events.dropped()) Serial.println("some events were dropped");
+}
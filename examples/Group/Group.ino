@@ -0,0 +1,26 @@
+#include "PITimerGroup.h"
+
+// three 1 kHz timers started in phase, and staggered by a third
+// of a period each, so their interrupts never come due together.
+// pins 2, 3 and 4 show the three phases on a scope
+PITimerGroup group;
+
+void toggle2() { digitalWriteFast(2, !digitalReadFast(2)); }
+void toggle3() { digitalWriteFast(3, !digitalReadFast(3)); }
+void toggle4() { digitalWriteFast(4, !digitalReadFast(4)); }
+
+void setup() {
+  pinMode(2, OUTPUT);
+  pinMode(3, OUTPUT);
+  pinMode(4, OUTPUT);
+  PITimer0.frequency(1000);
+  PITimer1.frequency(1000);
+  PITimer2.frequency(1000);
+  group.add(PITimer0, toggle2);
+  group.add(PITimer1, toggle3, F_BUS / 3000); // a third of a period later
+  group.add(PITimer2, toggle4, F_BUS / 1500); // two thirds
+  group.start();
+}
+
+void loop() {
+}
@@ -0,0 +1,42 @@
+#include "PITimer.h"
+
+// set PITIMER_PROFILE to 1 in PITimerConfig.h to build this
+#if !PITIMER_PROFILE
+#error "PITIMER_PROFILE must be set to 1 in PITimerConfig.h"
+#endif
+
+volatile uint32_t total;
+
+void myCallback() {
+  // some busy work to measure
+  for (int i = 0; i < 100; i++) total += i;
+}
+
+void printStats(const char* name, const PITimerStats& stats) {
+  Serial.print(name);
+  Serial.print(": min ");
+  Serial.print(stats.min());
+  Serial.print(", mean ");
+  Serial.print(stats.mean());
+  Serial.print(", max ");
+  Serial.print(stats.max());
+  Serial.print(" cycles, histogram");
+  for (int i = 0; i < PITimerStats::buckets; i++) {
+    Serial.print(' ');
+    Serial.print(stats.bucket(i));
+  }
+  Serial.println();
+}
+
+void setup() {
+  Serial.begin(true);
+  PITimer1.frequency(10000);
+  PITimer1.start(myCallback);
+}
+
+void loop() {
+  delay(1000);
+  PITimerProfile profile = PITimer1.profile();
+  printStats("latency", profile.latency);
+  printStats("duration", profile.duration);
+}
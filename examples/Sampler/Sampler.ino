@@ -0,0 +1,31 @@
+#include "PITimerSampler.h"
+
+// finds out where loop() spends its time. this needs
+// PITIMER_SAMPLER set to 1 in PITimerConfig.h, which hands
+// PITimer2 over to the sampler. send a 'd' over serial to get
+// a dump, save it to a file, and run extras/PITimerSampler.py
+// on it along with the sketch's .elf file for a flat profile
+
+volatile float result;
+
+void slowMath() {
+  for (int i = 0; i < 200; i++) result = result * 1.0001f + 0.5f;
+}
+
+void fastMath() {
+  for (int i = 0; i < 200; i++) result = result + i;
+}
+
+void setup() {
+  Serial.begin(true);
+  PITimerSampler::start(); // 997 Hz
+}
+
+void loop() {
+  slowMath();
+  fastMath();
+  if (Serial.read() == 'd') {
+    PITimerSampler::dump(Serial);
+    PITimerSampler::zero();
+  }
+}
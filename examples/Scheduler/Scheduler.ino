@@ -0,0 +1,55 @@
+#include "PITimerScheduler.h"
+
+// three control loops at 1 kHz, 100 Hz and 10 Hz on one timer,
+// instead of one timer each. the 100 Hz loop is offset by half a
+// millisecond so it never lands on the same tick as the 1 kHz one,
+// and the 10 Hz report runs from loop(), where printing is safe
+volatile uint32_t fastRuns;
+volatile uint32_t mediumRuns;
+
+void fast() {
+  // runs every millisecond, in the timer's interrupt
+  fastRuns++;
+}
+
+void medium() {
+  // runs every 10 ms, half a millisecond after fast()
+  mediumRuns++;
+}
+
+void report() {
+  // runs every 100 ms, from loop()
+  Serial.print(fastRuns);
+  Serial.print(" ");
+  Serial.println(mediumRuns);
+}
+
+const PITimerTask tasks[] = {
+  { fast, 1000, 0, PITIMER_IN_ISR, 2000 },       // budget: 2000 bus cycles
+  { medium, 10000, 500, PITIMER_IN_ISR, 10000 },
+  { report, 100000, 0, PITIMER_IN_LOOP, 200000 },
+};
+
+PITimerScheduler<3> scheduler(PITimer0, tasks);
+
+void setup() {
+  Serial.begin(true);
+  delay(1000);
+  bool ok = scheduler.begin();
+  const PITimerScheduleReport& r = scheduler.report();
+  Serial.print("tick: ");
+  Serial.print(r.tick);
+  Serial.print(" cycles, rates: ");
+  Serial.print(r.rates);
+  Serial.print(", isr load: ");
+  Serial.print(r.isrLoad / 10000.0);
+  Serial.print("%, loop load: ");
+  Serial.print(r.loopLoad / 10000.0);
+  Serial.print("%, peak: ");
+  Serial.print(r.peak);
+  Serial.println(ok ? " cycles, feasible" : " cycles, NOT feasible");
+}
+
+void loop() {
+  scheduler.run();
+}
@@ -0,0 +1,39 @@
+#include "PITimerWheel.h"
+
+PITimerWheel wheel(PITimer0); // 1 tick = 1 microsecond
+PITimerSoft blink;
+PITimerSoft report;
+PITimerSoft timeout;
+bool ledState;
+
+void blinkCallback() {
+  // runs every 250 ms
+  ledState = !ledState;
+  digitalWrite(13, ledState);
+}
+
+void reportCallback() {
+  // runs every second
+  Serial.print("ticks: ");
+  Serial.println(wheel.now());
+}
+
+void timeoutCallback() {
+  // runs once, 10 seconds after setup()
+  wheel.cancel(blink);
+}
+
+void setup() {
+  Serial.begin(true);
+  pinMode(13, OUTPUT);
+  blink.callback(blinkCallback);
+  report.callback(reportCallback);
+  timeout.callback(timeoutCallback);
+  wheel.begin();
+  wheel.schedule(blink, 250000, 250000);
+  wheel.schedule(report, 1000000, 1000000);
+  wheel.schedule(timeout, 10000000);
+}
+
+void loop() {
+}
@@ -0,0 +1,39 @@
+#include "PITimerMotion.h"
+
+// moves a stepper back and forth between two positions, with
+// a step/direction driver (A4988, DRV8825 and the like) on
+// pins 2 and 3. the ramps are worked out as it goes, in the
+// timer's interrupt
+const uint8_t stepPin = 2;
+const uint8_t dirPin = 3;
+
+void step() {
+  digitalWriteFast(stepPin, HIGH);
+  delayMicroseconds(1);
+  digitalWriteFast(stepPin, LOW);
+}
+
+void direction();
+
+PITimerMotion motor(PITimer0, step, direction);
+
+void direction() {
+  digitalWriteFast(dirPin, motor.forward() ? HIGH : LOW);
+}
+
+void setup() {
+  Serial.begin(true);
+  pinMode(stepPin, OUTPUT);
+  pinMode(dirPin, OUTPUT);
+  motor.speed(4000);        // steps per second
+  motor.acceleration(8000); // steps per second squared
+}
+
+void loop() {
+  if (!motor.moving()) {
+    Serial.print("at ");
+    Serial.println(motor.position());
+    delay(500);
+    motor.moveTo(motor.position() == 0 ? 3200 : 0);
+  }
+}
@@ -0,0 +1,42 @@
+#include "PITimerWheel.h"
+
+PITimerWheel wheel(PITimer0); // 1 tick = 1 microsecond
+PITimerSoft measure;
+PITimerSoft ledOff;
+volatile bool measureDue;
+
+void measureCallback() {
+  // runs every 10 seconds, and leaves the work for loop()
+  measureDue = true;
+  digitalWrite(13, HIGH);
+  wheel.schedule(ledOff, 5000);
+}
+
+void ledOffCallback() {
+  // runs once, 5 ms after the LED went on
+  digitalWrite(13, LOW);
+}
+
+void setup() {
+  Serial.begin(true);
+  pinMode(13, OUTPUT);
+  measure.callback(measureCallback);
+  ledOff.callback(ledOffCallback);
+  wheel.begin();
+  wheel.schedule(measure, 10000000, 10000000);
+}
+
+void loop() {
+  if (measureDue) {
+    measureDue = false;
+    Serial.print(millis());
+    Serial.print(" ms: ");
+    Serial.println(analogRead(0));
+  }
+  // sleeps until the next interrupt, and keeps millis() right.
+  // interrupts are off from the check to the WFI, so one that sets
+  // measureDue in between still ends the sleep straight away
+  __disable_irq();
+  if (!measureDue) wheel.sleep();
+  __enable_irq();
+}
@@ -0,0 +1,29 @@
+#include "PITimerTable.h"
+
+// a 2 kHz time-triggered frame with three slots: read the sensor at
+// the start of the frame, run the control law 100 us later, and
+// write the output 300 us in. the slots, their budgets and the
+// timer values between them are all checked and worked out by the
+// compiler, so moving a slot too close to another won't build.
+// pins 2, 3 and 4 pulse at the start of each slot
+const uint32_t us = F_BUS / 1000000;
+
+void readSensor()  { digitalWriteFast(2, HIGH); digitalWriteFast(2, LOW); }
+void controlLaw()  { digitalWriteFast(3, HIGH); digitalWriteFast(3, LOW); }
+void writeOutput() { digitalWriteFast(4, HIGH); digitalWriteFast(4, LOW); }
+
+typedef PITimerTable<500 * us,
+  PITimerSlot<0, readSensor, 50 * us>,    // may take up to 50 us
+  PITimerSlot<100 * us, controlLaw, 150 * us>,
+  PITimerSlot<300 * us, writeOutput, 50 * us>
+> Schedule;
+
+void setup() {
+  pinMode(2, OUTPUT);
+  pinMode(3, OUTPUT);
+  pinMode(4, OUTPUT);
+  Schedule::start(PITimer0);
+}
+
+void loop() {
+}
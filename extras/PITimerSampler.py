@@ -0,0 +1,86 @@
+#!/usr/bin/env python
+# Daniel Gilbert
+# loglow@gmail.com
+# copyright 2013
+
+# ------------------------------------------------------------
+# turns a dump from PITimerSampler::dump() into a flat profile,
+# by function. the dump is read from a file, which can be a raw
+# capture of the serial port with other output around it: the
+# first "PCS1" marks the start. the function names and sizes come
+# from the sketch's ELF file, via nm. a bucket which spans several
+# functions is shared out between them by how many of its bytes
+# each one covers. usage:
+#   PITimerSampler.py dump.bin sketch.elf [--nm arm-none-eabi-nm]
+# ------------------------------------------------------------
+
+import argparse
+import struct
+import subprocess
+import sys
+
+
+def read_dump(path):
+    data = open(path, 'rb').read()
+    start = data.find(b'PCS1')
+    if start < 0:
+        sys.exit('no PITimerSampler dump found in ' + path)
+    shift, scale, entries, base, samples, outside, rate = struct.unpack_from('<BBHIIII', data, start + 4)
+    counts = {}
+    for i in range(entries):
+        index, count = struct.unpack_from('<HH', data, start + 24 + 4 * i)
+        counts[index] = count << scale
+    return shift, base, samples, outside << scale, rate, counts
+
+
+def read_symbols(nm, elf):
+    out = subprocess.check_output([nm, '-C', '-S', '-n', '--defined-only', elf])
+    symbols = []
+    for line in out.decode('utf-8', 'replace').splitlines():
+        parts = line.split(None, 3)
+        if len(parts) < 4 or parts[2] not in 'tTwW':
+            continue
+        address = int(parts[0], 16) & ~1
+        size = int(parts[1], 16)
+        if size:
+            symbols.append((address, address + size, parts[3]))
+    return symbols
+
+
+def profile(shift, base, counts, symbols):
+    width = 1 << shift
+    totals = {}
+    for index, count in counts.items():
+        low = base + (index << shift)
+        high = low + width
+        covered = 0
+        for start, end, name in symbols:
+            if end <= low or start >= high:
+                continue
+            overlap = min(end, high) - max(start, low)
+            totals[name] = totals.get(name, 0) + float(count) * overlap / width
+            covered += overlap
+        if covered < width:
+            totals['<unknown>'] = totals.get('<unknown>', 0) + float(count) * (width - covered) / width
+    return totals
+
+
+def main():
+    parser = argparse.ArgumentParser(description='flat profile from a PITimerSampler dump')
+    parser.add_argument('dump')
+    parser.add_argument('elf')
+    parser.add_argument('--nm', default='arm-none-eabi-nm')
+    args = parser.parse_args()
+    shift, base, samples, outside, rate, counts = read_dump(args.dump)
+    totals = profile(shift, base, counts, read_symbols(args.nm, args.elf))
+    if outside:
+        totals['<outside of flash>'] = outside
+    total = sum(totals.values()) or 1
+    print('%d samples at %.3f Hz, %d-byte buckets' % (samples, rate / 1000.0, 1 << shift))
+    print('%7s %10s  %s' % ('%', 'samples', 'function'))
+    for name, count in sorted(totals.items(), key=lambda item: -item[1]):
+        print('%6.2f%% %10.1f  %s' % (100.0 * count / total, count, name))
+
+
+if __name__ == '__main__':
+    main()
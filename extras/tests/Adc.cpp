@@ -0,0 +1,60 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerADC.h"
+
+
+
+// ------------------------------------------------------------
+// PIT-triggered ADC sampling into a double buffer. the simulated
+// ADC returns a running count on the sampled channel, so every
+// block has to come out complete and in order, one sample per
+// timer period, with the callback finding the block that just
+// filled. pin 14 is A0, which is ADC0 channel 5
+// ------------------------------------------------------------
+static const uint16_t blockSize = 100;
+static uint16_t buffer[2 * blockSize];
+static uint16_t nextSample;
+static uint32_t ready;
+static uint32_t wrong;
+static PITimerADC adc(PITimer2);
+
+static uint16_t sample(uint8_t channel) {
+  return channel == 5 ? nextSample++ : 0xFFFF;
+}
+
+static void blockReady() {
+  const uint16_t* block = adc.block();
+  CHECK(block == buffer + (ready % 2) * blockSize);
+  for (uint16_t i = 0; i < blockSize; i++) {
+    if (block[i] != uint16_t(ready * blockSize + i)) wrong++;
+  }
+  ready++;
+}
+
+int main() {
+  PITimerTest::begin();
+  PITimerSim::analog = sample;
+  PITimer2.load(239);
+  CHECK(adc.start(14, buffer, blockSize, blockReady));
+  CHECK(adc.running());
+  PITimerSim::advance(240 * 1000 + 5);
+  CHECK(ready == 10);
+  CHECK(adc.blocks() == 10);
+  CHECK(wrong == 0);
+  CHECK(nextSample == 1000);
+  adc.stop();
+  CHECK(!adc.running());
+  PITimerSim::advance(240 * 100);
+  CHECK(nextSample == 1000);
+  CHECK(!adc.start(200, buffer, blockSize));
+  return PITimerTest::finish("Adc");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,370 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerWheel.h"
+#include "PITimerMotion.h"
+#include "PITimerScheduler.h"
+#include <chrono>
+#include <stdlib.h>
+
+
+
+// ------------------------------------------------------------
+// not a test, just numbers, each from a function of its own
+// below. they're host timings, so they only compare one build of
+// the library with another on the same machine, and say nothing
+// about the cycles the same code takes on the chip itself
+// ------------------------------------------------------------
+static const uint32_t rounds = 10000000;
+static volatile uint32_t calls;
+
+static void count() {
+  calls++;
+}
+
+static void countWith(void*) {
+  calls++;
+}
+
+static double since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+
+// ------------------------------------------------------------
+// the PITimer object against the class it replaced, rebuilt here
+// from the old PITimer.h with its register pointers aimed at the
+// simulated PIT: its size on the chip (with 32-bit pointers) and
+// here, and clear() and current() through a pointer to each (as a
+// sketch holding a PITimer& would call them) and on the template.
+// the old per-object state hasn't vanished, it's in the statics
+// of PITimerChannel<N>, which don't count towards sizeof()
+// ------------------------------------------------------------
+class OldPITimer {
+  private:
+    uint8_t myID;
+    uint32_t myValue;
+    uint32_t myCount;
+    bool isRunning;
+    PITimerReg* PIT_LDVAL;
+    PITimerReg* PIT_TCTRL;
+    PITimerReg* PIT_TFLG;
+    PITimerReg* PIT_CVAL;
+    uint8_t IRQ_PIT_CH;
+  public:
+    OldPITimer(uint8_t timerID) : myID(timerID), myValue(0), myCount(0), isRunning(false),
+      PIT_LDVAL(&PIT_CH(timerID).ldval), PIT_TCTRL(&PIT_CH(timerID).tctrl),
+      PIT_TFLG(&PIT_CH(timerID).tflg), PIT_CVAL(&PIT_CH(timerID).cval), IRQ_PIT_CH(timerID), myISR(0) {}
+    void clear() { *PIT_TFLG = 1; myCount++; }
+    uint32_t current() { return *PIT_CVAL; }
+    void (*myISR)();
+};
+
+struct OldPITimerOnChip {
+  uint8_t myID;
+  uint32_t myValue;
+  uint32_t myCount;
+  bool isRunning;
+  uint32_t registers[4];
+  uint8_t IRQ_PIT_CH;
+  uint32_t myISR;
+};
+
+static OldPITimer oldTimer(0);
+
+template <class F>
+static double perCall(F call) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < rounds; i++) call();
+  return since(start) * 1e9 / rounds;
+}
+
+static void benchLayout() {
+  PITimerTest::begin();
+  PITimer0.begin();
+  OldPITimer* volatile old = &oldTimer;
+  PITimer* volatile timer = &PITimer0;
+  volatile uint32_t sink;
+  printf("layout, old PITimer: %u bytes on the chip, %u here; new PITimer: %u byte\n",
+    unsigned(sizeof(OldPITimerOnChip)), unsigned(sizeof(OldPITimer)), unsigned(sizeof(PITimer)));
+  printf("layout, clear(): %.2f ns old, %.2f ns new, %.2f ns template\n",
+    perCall([&] { old->clear(); }), perCall([&] { timer->clear(); }), perCall([] { PITimerChannel<0>::clear(); }));
+  printf("layout, current(): %.2f ns old, %.2f ns new, %.2f ns template\n",
+    perCall([&] { sink = old->current(); }), perCall([&] { sink = timer->current(); }), perCall([&] { sink = PITimerChannel<0>::current(); }));
+}
+
+
+
+// ------------------------------------------------------------
+// a queue post() and poll()
+// ------------------------------------------------------------
+static PITimerQueue<1024> queue;
+
+static void benchQueue() {
+  PITimerEvent event;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < rounds; i++) {
+    queue.post(0, i, i);
+    queue.poll(event);
+  }
+  printf("queue post() + poll(): %.2f ns\n", since(start) * 1e9 / rounds);
+}
+
+
+
+// ------------------------------------------------------------
+// a wheel schedule() and (every other time) cancel(), and one of
+// the wheel's ISRs with 100,000 timers on it, on average and at
+// worst, which is when a whole block of them cascades down a level
+// ------------------------------------------------------------
+static PITimerWheel wheel(PITimer0);
+static PITimerSoft softs[64];
+static const uint32_t loadCount = 100000;
+static PITimerSoft loaded[loadCount];
+
+static void benchWheel() {
+  PITimerTest::begin();
+  wheel.begin();
+  for (uint8_t i = 0; i < 64; i++) softs[i].callback(count);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < rounds; i++) {
+    PITimerSoft& soft = softs[i & 63];
+    wheel.schedule(soft, 1000 + (i * 7919) % 1000000);
+    if (i & 1) wheel.cancel(soft);
+  }
+  printf("wheel schedule() + cancel()/2: %.2f ns\n", since(start) * 1e9 / rounds);
+  for (uint8_t i = 0; i < 64; i++) wheel.cancel(softs[i]);
+
+  PITimerTest::begin();
+  wheel.begin();
+  srand(1);
+  for (uint32_t i = 0; i < loadCount; i++) {
+    loaded[i].callback(count);
+    wheel.schedule(loaded[i], uint32_t(rand()) % 1600000 + 1, i < 100 ? uint32_t(rand()) % 3000 + 50 : 0);
+  }
+  double worst = 0;
+  double total = 0;
+  uint32_t isrs = 0;
+  for (uint32_t i = 0; i < 1700000 / 5; i++) {
+    uint32_t before = PITimer0.count();
+    start = std::chrono::steady_clock::now();
+    PITimerSim::advance(48 * 5);
+    double taken = since(start);
+    if (PITimer0.count() != before + 1) continue;
+    if (taken > worst) worst = taken;
+    total += taken;
+    isrs++;
+  }
+  printf("wheel ISR with %u timers: %.0f ns average, %.0f ns worst\n", loadCount, total * 1e9 / isrs, worst * 1e9);
+  wheel.end();
+}
+
+
+
+// ------------------------------------------------------------
+// each form of callback, called directly and then as a timer's
+// callback on the simulated PIT (at its shortest period), next to
+// a bare function pointer. the difference between the forms is
+// the trampoline a plain function goes through
+// ------------------------------------------------------------
+struct Counter {
+  void tick() { calls++; }
+};
+
+static Counter counter;
+static void (* volatile bare)() = count;
+static PITimerCallback forms[4];
+static const char* const formNames[] = { "plain", "context", "member", "lambda" };
+
+static void benchCallbacks() {
+  uint32_t* total = const_cast<uint32_t*>(&calls);
+  forms[0] = count;
+  forms[1] = PITimerCallback(countWith, 0);
+  forms[2] = PITimerCallback::bind<Counter, &Counter::tick>(counter);
+  forms[3] = [total] { (*total)++; };
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < rounds; i++) bare();
+  printf("callback, bare function pointer: %.2f ns\n", since(start) * 1e9 / rounds);
+  for (uint8_t form = 0; form < 4; form++) {
+    PITimerCallback* volatile callback = &forms[form];
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds; i++) (*callback)();
+    double direct = since(start) * 1e9 / rounds;
+    PITimerTest::begin();
+    PITimer1.value(PITimerMath::valueMin);
+    PITimer1.start(forms[form]);
+    start = std::chrono::steady_clock::now();
+    PITimerSim::advance(uint64_t(PITimerMath::valueMin + 1) * 1000000);
+    double isr = since(start) * 1e9 / 1000000;
+    PITimer1.stop();
+    printf("callback, %s: %.2f ns called directly, %.2f ns per simulated ISR\n", formNames[form], direct, isr);
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// retrigger() on a one-shot that's still counting down, the way
+// a timeout gets pushed back on every byte, and then on one that
+// has expired without its ISR having run, which is the path that
+// also folds in and throws away the pending expiry
+// ------------------------------------------------------------
+static void benchRetrigger() {
+  PITimerTest::begin();
+  PITimer0.value(47999);
+  PITimer0.once(count);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < rounds; i++) PITimer0.retrigger();
+  printf("retrigger(), counting down: %.2f ns\n", since(start) * 1e9 / rounds);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < rounds; i++) {
+    PIT_CH(0).cval = 0;
+    PIT_CH(0).tflg = 1;
+    PITimer0.retrigger();
+  }
+  printf("retrigger(), expiry pending: %.2f ns\n", since(start) * 1e9 / rounds);
+  PITimer0.stop();
+}
+
+
+
+// ------------------------------------------------------------
+// the stepper driver's step ISR, as steps per second of host time,
+// cruising at the PIT's top rate and then all the way through a
+// long ramp up and down, which takes the divide on every step.
+// the simulated PIT itself can't step faster than one expiry per
+// valueMin + 1 bus cycles, so that's printed alongside
+// ------------------------------------------------------------
+static PITimerMotion motor(PITimer0, count);
+
+static double benchMove(uint32_t acceleration, int32_t distance) {
+  PITimerTest::begin();
+  calls = 0;
+  motor.position(0);
+  motor.speed(F_BUS);
+  motor.acceleration(acceleration);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  motor.move(distance);
+  while (motor.moving()) PITimerSim::advance(uint64_t(F_BUS));
+  return calls / since(start);
+}
+
+static void benchMotion() {
+  printf("motion, PIT limit: %u steps/s\n", F_BUS / (PITimerMath::valueMin + 1));
+  printf("motion, cruising: %.2f M steps/s of host time\n", benchMove(0, 2000000) / 1e6);
+  printf("motion, ramping: %.2f M steps/s of host time\n", benchMove(1000, 1000000) / 1e6);
+}
+
+
+
+// ------------------------------------------------------------
+// the scheduler's tick ISR on the simulated PIT, for 1 kHz, 100 Hz
+// and 10 Hz tasks in the ISR plus one in the loop, and then for
+// sixteen tasks spread over the same rates, next to a timer with a
+// bare callback at the same tick. the tick only visits the rate
+// groups that are due, so what the bigger table adds is mostly
+// its extra callbacks
+// ------------------------------------------------------------
+static const PITimerTask fewTasks[] = {
+  { count, 1000, 0, PITIMER_IN_ISR, 0 },
+  { count, 10000, 0, PITIMER_IN_ISR, 0 },
+  { count, 100000, 0, PITIMER_IN_ISR, 0 },
+  { count, 100000, 500, PITIMER_IN_LOOP, 0 },
+};
+
+static const PITimerTask manyTasks[] = {
+  { count, 1000, 0, PITIMER_IN_ISR, 0 },
+  { count, 1000, 0, PITIMER_IN_ISR, 0 },
+  { count, 1000, 0, PITIMER_IN_ISR, 0 },
+  { count, 1000, 0, PITIMER_IN_ISR, 0 },
+  { count, 10000, 0, PITIMER_IN_ISR, 0 },
+  { count, 10000, 1000, PITIMER_IN_ISR, 0 },
+  { count, 10000, 2000, PITIMER_IN_ISR, 0 },
+  { count, 10000, 3000, PITIMER_IN_ISR, 0 },
+  { count, 100000, 0, PITIMER_IN_ISR, 0 },
+  { count, 100000, 10000, PITIMER_IN_ISR, 0 },
+  { count, 100000, 20000, PITIMER_IN_ISR, 0 },
+  { count, 100000, 30000, PITIMER_IN_ISR, 0 },
+  { count, 100000, 0, PITIMER_IN_LOOP, 0 },
+  { count, 100000, 10000, PITIMER_IN_LOOP, 0 },
+  { count, 100000, 20000, PITIMER_IN_LOOP, 0 },
+  { count, 100000, 30500, PITIMER_IN_LOOP, 0 },
+};
+
+static PITimerScheduler<4> fewScheduler(PITimer0, fewTasks);
+static PITimerScheduler<16> manyScheduler(PITimer0, manyTasks);
+
+template <uint8_t N>
+static double benchTicks(PITimerScheduler<N>& scheduler) {
+  PITimerTest::begin();
+  scheduler.begin();
+  uint32_t tick = scheduler.report().tick;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < 1000000; i++) {
+    PITimerSim::advance(tick);
+    scheduler.run();
+  }
+  double taken = since(start) * 1e9 / 1000000;
+  PITimer0.stop();
+  return taken;
+}
+
+static void benchScheduler() {
+  double few = benchTicks(fewScheduler);
+  double many = benchTicks(manyScheduler);
+  PITimerTest::begin();
+  PITimer0.value(fewScheduler.report().tick - 1);
+  PITimer0.start(count);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < 1000000; i++) PITimerSim::advance(fewScheduler.report().tick);
+  double bare = since(start) * 1e9 / 1000000;
+  PITimer0.stop();
+  printf("scheduler tick + run(), 4 tasks: %.2f ns, 16 tasks: %.2f ns, bare timer: %.2f ns\n", few, many, bare);
+}
+
+
+
+// ------------------------------------------------------------
+// how many simulated bus cycles the simulator gets through per
+// second, with all three channels interrupting at 10 kHz
+// ------------------------------------------------------------
+static void benchSimulator() {
+  PITimerTest::begin();
+  calls = 0;
+  PITimer0.frequency(10000);
+  PITimer1.frequency(10000);
+  PITimer2.frequency(10000);
+  PITimer0.start(count);
+  PITimer1.start(count);
+  PITimer2.start(count);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  PITimerSim::advance(uint64_t(F_BUS) * 10);
+  double seconds = since(start);
+  printf("simulator: %.1f M bus cycles/s, %.1f M ISRs/s\n", F_BUS * 10 / seconds / 1e6, calls / seconds / 1e6);
+  PITimer0.stop();
+  PITimer1.stop();
+  PITimer2.stop();
+}
+
+
+
+int main() {
+  benchLayout();
+  benchQueue();
+  benchWheel();
+  benchCallbacks();
+  benchRetrigger();
+  benchMotion();
+  benchScheduler();
+  benchSimulator();
+  return 0;
+}
+
+
+
+// EOF
\ No newline at end of file
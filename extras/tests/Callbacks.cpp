@@ -0,0 +1,73 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+// ------------------------------------------------------------
+// every form of callback start() accepts, each run by a real
+// timer: a plain function, a function with a context, a member
+// function, and a lambda with captures. a copy of a callback
+// that keeps its captures inline has to carry them along
+// ------------------------------------------------------------
+static uint32_t plainCalls;
+static uint32_t contextCalls;
+
+static void plain() {
+  plainCalls++;
+}
+
+static void withContext(void* context) {
+  *static_cast<uint32_t*>(context) += 1;
+}
+
+class Counter {
+  public:
+    uint32_t calls;
+    void bump() { calls++; }
+};
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(47999);
+
+  PITimer0.start(plain);
+  PITimerSim::advance(48000 * 3);
+  CHECK(plainCalls == 3);
+
+  PITimer0.start(withContext, &contextCalls);
+  PITimerSim::advance(48000 * 2);
+  CHECK(contextCalls == 2);
+
+  Counter counter = Counter();
+  PITimer0.start(PITimerCallback::bind<Counter, &Counter::bump>(counter));
+  PITimerSim::advance(48000 * 4);
+  CHECK(counter.calls == 4);
+
+  uint32_t total = 0;
+  uint32_t step = 5;
+  uint32_t* target = &total;
+  PITimer0.start([target, step] { *target += step; });
+  PITimerSim::advance(48000 * 2);
+  CHECK(total == 10);
+  PITimer0.stop();
+
+  PITimerCallback original([target] { *target += 100; });
+  PITimerCallback copy(original);
+  PITimerCallback assigned;
+  CHECK(assigned.empty());
+  assigned = copy;
+  CHECK(!assigned.empty());
+  copy();
+  assigned();
+  CHECK(total == 210);
+  return PITimerTest::finish("Callbacks");
+}
+
+
+
+// EOF
\ No newline at end of file
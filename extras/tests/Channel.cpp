@@ -0,0 +1,73 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include <vector>
+
+
+
+// ------------------------------------------------------------
+// the compile-time channels and the PITimer shim over them: both
+// reach the same registers of the same channel (through the
+// PITimerChannelRegs overlay), a channel brings the PIT up by
+// itself the first time it's used, and a started timer fires
+// exactly once per period, LDVAL + 1 cycles apart
+// ------------------------------------------------------------
+static std::vector<uint64_t> fired;
+
+static void tick() {
+  fired.push_back(PITimerSim::now());
+}
+
+int main() {
+  CHECK(sizeof(PITimer) == 1);
+  CHECK(sizeof(PITimerChannelRegs) == PITIMER_CH_STRIDE);
+  CHECK(&PIT_CH(2).tctrl == &PITimerSim::pit[2][2]);
+
+  CHECK(!(PITimerSim::scgc6 & SIM_SCGC6_PIT));
+  CHECK(PITimer2.current() == 0);
+  CHECK(!PITimer2.expired());
+  CHECK(PITimerSim::scgc6 & SIM_SCGC6_PIT);
+  CHECK(PITimerSim::pit[2][0] == F_BUS);
+  CHECK(PITimerSim::pit[1][0] == 0);
+  PITimerChannel<1>::start(tick);
+  CHECK(PITimerSim::pit[1][0] == F_BUS);
+  CHECK(PITimerSim::pit[0][0] == 0);
+  PITimerSim::advance(uint64_t(F_BUS) * 3 + 10);
+  CHECK(fired.size() == 3);
+  PITimerChannel<1>::stop();
+
+  PITimerTest::begin();
+  fired.clear();
+  PITimerChannel<1>::value(47999);
+  CHECK(PITimerSim::pit[1][0] == 47999);
+  CHECK(PITimer1.value() == 47999);
+  PITimer1.value(23999);
+  CHECK(PITimerChannel<1>::value() == 23999);
+  PITimer1.value(1);
+  CHECK(PITimer1.value() == PITimerMath::valueMin);
+  PITimer1.value(UINT32_MAX);
+  CHECK(PITimer1.value() == UINT32_MAX - 1);
+
+  PITimer1.value(47999);
+  PITimer1.zero();
+  uint64_t start = PITimerSim::now();
+  PITimer1.start(tick);
+  CHECK(PITimer1.running());
+  CHECK(PITimerSim::pit[1][2] == 3);
+  PITimerSim::advance(48000 * 10);
+  CHECK(fired.size() == 10 && PITimer1.count() == 10);
+  for (size_t i = 0; i < fired.size(); i++) CHECK(fired[i] == start + 48000 * (i + 1));
+  PITimer1.stop();
+  CHECK(!PITimer1.running() && PITimerSim::pit[1][2] == 0);
+  PITimerSim::advance(48000 * 10);
+  CHECK(fired.size() == 10);
+  return PITimerTest::finish("Channel");
+}
+
+
+
+// EOF
\ No newline at end of file
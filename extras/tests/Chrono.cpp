@@ -0,0 +1,53 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerChrono.h"
+
+
+
+// ------------------------------------------------------------
+// std::chrono periods, remains() and PITimerClock. durations are
+// converted exactly at compile time where they can be, and
+// clamped to the PIT's range
+// ------------------------------------------------------------
+using namespace std::chrono;
+
+static_assert(PITimerValue(microseconds(50)) == 2399, "50 us");
+static_assert(PITimerValue(milliseconds(1)) == 47999, "1 ms");
+static_assert(PITimerValue(duration<int, std::ratio<1, 44100> >(1)) == 1087, "1/44100 s");
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.period(microseconds(50));
+  CHECK(PITimer0.value() == 2399);
+  PITimer0.period(seconds(5));
+  CHECK(PITimer0.value() == 239999999);
+  PITimer0.period(nanoseconds(1));
+  CHECK(PITimer0.value() == PITimerMath::valueMin);
+  PITimer0.period(hours(1));
+  CHECK(PITimer0.value() == PITimerMath::valueMax);
+  PITimer0.period(seconds(-1));
+  CHECK(PITimer0.value() == PITimerMath::valueMin);
+  PITimerChannel<1>::period(milliseconds(2));
+  CHECK(PITimer1.value() == 95999);
+
+  PITimer0.period(milliseconds(10));
+  PITimer0.start();
+  PITimerSim::advance(48000 * 3);
+  CHECK(PITimer0.remains<microseconds>() == microseconds(7000));
+  CHECK(PITimerChannel<0>::remains<PITimerCycles>().count() == 336000 - 1);
+  PITimerClock<0>::time_point before = PITimerClock<0>::now();
+  PITimerSim::advance(48000 * 25);
+  CHECK(duration_cast<microseconds>(PITimerClock<0>::now() - before).count() == 25000);
+  CHECK(PITimerClock<0>::is_steady);
+  PITimer0.stop();
+  return PITimerTest::finish("Chrono");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+// ------------------------------------------------------------
+// frequencyExact() over millions of periods. measured from the
+// first expiry, the k-th one has to land within one bus cycle of
+// k times the exact period, however many periods have gone by, so
+// the average frequency is exact and there's no drift. a rate
+// that divides the bus clock evenly shouldn't dither at all
+// ------------------------------------------------------------
+static uint32_t rateNum;
+static uint32_t rateDen;
+static uint64_t first;
+static uint64_t periods;
+static int64_t lowest;
+static int64_t highest;
+
+static void tick() {
+  uint64_t now = PITimerSim::now();
+  if (!periods++) first = now;
+  // in units of 1 / rateNum cycles, to stay exact
+  int64_t error = int64_t((now - first) * rateNum) - int64_t((periods - 1) * uint64_t(F_BUS) * rateDen);
+  if (error < lowest) lowest = error;
+  if (error > highest) highest = error;
+  CHECK(PITimer0.phaseError() < 65536);
+}
+
+static void run(uint32_t num, uint32_t den, uint64_t count, bool dithers) {
+  rateNum = num;
+  rateDen = den;
+  periods = 0;
+  lowest = 0;
+  highest = 0;
+  PITimer0.stop();
+  PITimer0.frequencyExact(num, den);
+  CHECK(PITimer0.dithering() == dithers);
+  PITimer0.start(tick);
+  PITimerSim::advance(count * F_BUS * den / num);
+  CHECK(periods == count || periods + 1 == count);
+  CHECK(highest - lowest < int64_t(num));
+}
+
+int main() {
+  PITimerTest::begin();
+  run(44100, 1, 3000000, true);
+  run(74000, 1, 3000000, true);
+  run(3000000, 1001, 1000000, false);
+  run(48000, 1, 100000, false);
+  run(30000000, 1001, 100000, true);
+  PITimer0.frequencyExact(44100);
+  PITimer0.value(1000);
+  CHECK(!PITimer0.dithering());
+  PITimer0.stop();
+  return PITimerTest::finish("Dither");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerDMA.h"
+
+
+
+// ------------------------------------------------------------
+// a buffer played into a fixed address by DMA, one element per
+// period of PIT channel 1: the target has to hold the right
+// element after every period, the half and full callbacks have to
+// come once per pass through the buffer, and nothing may move
+// after stop()
+// ------------------------------------------------------------
+static volatile uint16_t target;
+static const uint16_t wave[8] = { 10, 20, 30, 40, 50, 60, 70, 80 };
+static uint32_t halves;
+static uint32_t fulls;
+
+static void half() {
+  halves++;
+  CHECK(PITimerDMA<1>::position() == 4);
+}
+
+static void full() {
+  fulls++;
+}
+
+int main() {
+  PITimerTest::begin();
+  PITimer1.load(47);
+  PITimerDMA<1>::start(wave, 8, &target, half, full);
+  uint32_t wrong = 0;
+  for (uint32_t i = 0; i < 40; i++) {
+    PITimerSim::advance(48);
+    if (target != wave[i % 8]) wrong++;
+  }
+  CHECK(wrong == 0);
+  CHECK(halves == 5);
+  CHECK(fulls == 5);
+  CHECK(PITimerDMA<1>::position() == 0);
+  CHECK(PITimer1.count() == 0);
+  PITimerDMA<1>::stop();
+  uint16_t last = target;
+  PITimerSim::advance(48 * 20);
+  CHECK(target == last);
+  CHECK(fulls == 5);
+
+  uint32_t words[3] = { 1, 2, 3 };
+  volatile uint32_t port = 0;
+  PITimer2.load(99);
+  PITimerDMA<2>::start(words, 3, &port);
+  PITimerSim::advance(100 * 4);
+  CHECK(port == 1);
+  CHECK(!PITimerSim::enabled(IRQ_DMA_CH2));
+  PITimerDMA<2>::stop();
+  return PITimerTest::finish("Dma");
+}
+
+
+
+// EOF
\ No newline at end of file
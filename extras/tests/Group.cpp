@@ -0,0 +1,80 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerGroup.h"
+#include <vector>
+
+
+
+// ------------------------------------------------------------
+// the phase relations of a group: started together, timers with
+// the same period fire on the same bus cycle, an offset holds a
+// timer that far behind the others for good, and a timer with
+// half the period fires exactly twice per period of the others.
+// restarting the group (with one timer dithering) lines them all
+// up again from the new start, and now() stays exact throughout
+// ------------------------------------------------------------
+static std::vector<uint64_t> fired[3];
+
+static void record(void* context) {
+  fired[reinterpret_cast<uintptr_t>(context)].push_back(PITimerSim::now());
+}
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(47999);
+  PITimer1.value(47999);
+  PITimer2.value(23999);
+  PITimerGroup group;
+  CHECK(group.add(PITimer0, PITimerCallback(record, (void*)0)));
+  CHECK(group.add(PITimer1, PITimerCallback(record, (void*)1), 16000));
+  CHECK(group.add(PITimer2, PITimerCallback(record, (void*)2), 1000));
+  CHECK(!group.add(PITimer1));
+  CHECK(group.size() == 3);
+
+  PITimerSim::advance(12345);
+  uint64_t start = PITimerSim::now();
+  group.start();
+  PITimerSim::advance(48000 * 100);
+  CHECK(fired[0].size() == 100);
+  CHECK(fired[1].size() == 99);
+  CHECK(fired[2].size() == 199);
+  for (size_t i = 0; i < 99; i++) {
+    CHECK(fired[0][i] == start + 48000 * (i + 1));
+    CHECK(fired[1][i] == fired[0][i] + 16000);
+  }
+  for (size_t i = 0; i < 199; i++) CHECK(fired[2][i] == start + 24000 * (i + 1) + 1000);
+  CHECK(PITimer0.now() == PITimerSim::now() - start);
+  CHECK(PITimer1.now() == PITimerSim::now() - start);
+  CHECK(PITimer2.now() == PITimerSim::now() - start);
+
+  for (uint8_t i = 0; i < 3; i++) fired[i].clear();
+  PITimer2.frequencyExact(7000);
+  PITimerSim::advance(777);
+  uint64_t restart = PITimerSim::now();
+  uint64_t before = PITimer1.now();
+  group.start();
+  PITimerSim::advance(48000 * 70);
+  CHECK(fired[0][0] == restart + 48000);
+  CHECK(fired[1][0] == restart + 48000 + 16000);
+  uint64_t span = fired[2].back() - restart - 1000;
+  uint64_t periods = fired[2].size();
+  CHECK(span * 7000 >= periods * F_BUS - 7000 && span * 7000 <= periods * F_BUS + 7000);
+  CHECK(PITimer1.now() - before == PITimerSim::now() - restart);
+
+  CHECK(group.remove(PITimer1));
+  CHECK(!group.remove(PITimer1));
+  CHECK(group.size() == 2);
+  group.stop();
+  CHECK(!PITimer0.running() && !PITimer2.running() && PITimer1.running());
+  PITimer1.stop();
+  return PITimerTest::finish("Group");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,48 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerLiterals.h"
+
+
+
+// ------------------------------------------------------------
+// the compile-time literals. the values are checked by the
+// compiler itself, and then again through the timers. the ones
+// that must not compile (1000_ns, too short, and 44.1_kHz, 400
+// ppm off) can be tried by defining PITIMER_TEST_REJECTS
+// ------------------------------------------------------------
+static_assert((2000_Hz).value == 23999, "2 kHz");
+static_assert((50_us).value == 2399, "50 us");
+static_assert((0.5_ms).value == 23999, "0.5 ms");
+static_assert((2.5_kHz).value == 19199, "2.5 kHz");
+static_assert((1_s).value == 47999999, "1 s");
+static_assert((1000000_ns).value == 47999, "1 ms in ns");
+
+#ifdef PITIMER_TEST_REJECTS
+static_assert((1000_ns).value, "too short");
+static_assert((44.1_kHz).value, "not a whole number of cycles");
+#endif
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.frequency(2000_Hz);
+  CHECK(PITimer0.value() == 23999);
+  PITimer0.period(50_us);
+  CHECK(PITimer0.value() == 2399);
+  PITimerChannel<0>::period(1_ms);
+  CHECK(PITimer0.value() == 47999);
+  PITimer0.period(89_s);
+  CHECK(PITimer0.value() == 89u * 48000000 - 1);
+  constexpr PITimerConstant audio = 44_kHz;
+  PITimer1.frequency(audio);
+  CHECK(PITimer1.value() == 1090);
+  return PITimerTest::finish("Literals");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,145 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+// ------------------------------------------------------------
+// divRound() on both sides of the switch from a 32-bit divide to
+// a 64-bit one, and the conversions that end up on the 64-bit
+// side: nanoseconds past about 0.7 s, microseconds past the
+// longest period, and every frequency (48e9 mHz doesn't fit in
+// 32 bits). then the exact ends of the range, valueMin and
+// valueMax, and their neighbours, through clampValue(),
+// checkedValue() and value()
+// ------------------------------------------------------------
+static_assert(PITimerMath::divRound(UINT32_MAX - 1, 2) == 2147483647, "last 32-bit divRound()");
+static_assert(PITimerMath::divRound(UINT32_MAX, 2) == 2147483648u, "first 64-bit divRound()");
+static_assert(PITimerMath::checkedValue(PITimerMath::valueMin + 1) == PITimerMath::valueMin, "valueMin");
+static_assert(PITimerMath::checkedValue(uint64_t(PITimerMath::valueMax) + 1) == PITimerMath::valueMax, "valueMax");
+
+static void checkRanges() {
+  CHECK(PITimerMath::divRound(1099511627776ull, 3) == 366503875925ull);
+  CHECK(PITimerMath::divRound(1ull << 33, 1ull << 33) == 1);
+  CHECK(PITimerMath::divRound((1ull << 32) - 1, 1ull << 33) == 0);
+  CHECK(PITimerMath::divRound(1ull << 32, 1ull << 33) == 1);
+  PITimer0.periodNanos(715827872);
+  CHECK(PITimer0.value() == 34359737);
+  PITimer0.periodNanos(715827873);
+  CHECK(PITimer0.value() == 34359737);
+  PITimer0.periodNanos(89478485000ull);
+  CHECK(PITimer0.value() == 4294967279u);
+  CHECK(PITimer0.periodNanos() == 89478485000ull);
+  PITimer0.periodNanos(89478485300ull);
+  CHECK(PITimer0.value() == PITimerMath::valueMax - 1);
+  PITimer0.periodNanos(89478485312ull);
+  CHECK(PITimer0.value() == PITimerMath::valueMax);
+  PITimer0.periodNanos(89478485333ull);
+  CHECK(PITimer0.value() == PITimerMath::valueMax);
+  PITimer0.periodNanos(UINT64_MAX / 2 / 6 + 1);
+  CHECK(PITimer0.value() == PITimerMath::valueMax);
+  PITimer0.periodMicros(89478485);
+  CHECK(PITimer0.value() == 4294967279u);
+  PITimer0.periodMicros(89478486);
+  CHECK(PITimer0.value() == PITimerMath::valueMax);
+  PITimer0.frequencyMillihertz(11);
+  CHECK(PITimer0.value() == PITimerMath::valueMax);
+  PITimer0.frequencyMillihertz(12);
+  CHECK(PITimer0.value() == 3999999999u);
+  CHECK(PITimer0.frequencyMillihertz() == 12);
+
+  volatile uint64_t cycles[] = { 0, 639, 640, 641, uint64_t(UINT32_MAX) - 1, UINT32_MAX, uint64_t(UINT32_MAX) + 1, UINT64_MAX };
+  const uint32_t clamped[] = { 639, 639, 639, 640, UINT32_MAX - 2, UINT32_MAX - 1, UINT32_MAX - 1, UINT32_MAX - 1 };
+  for (uint8_t i = 0; i < 8; i++) {
+    CHECK(PITimerMath::clampValue(cycles[i]) == clamped[i]);
+    CHECK(PITimerMath::checkedValue(cycles[i]) == clamped[i]);
+  }
+  const uint32_t values[] = { 0, 638, 639, 640, UINT32_MAX - 2, UINT32_MAX - 1, UINT32_MAX };
+  const uint32_t set[] = { 639, 639, 639, 640, UINT32_MAX - 2, UINT32_MAX - 1, UINT32_MAX - 1 };
+  for (uint8_t i = 0; i < 7; i++) {
+    PITimer0.value(values[i]);
+    CHECK(PITimer0.value() == set[i]);
+  }
+}
+
+
+
+// ------------------------------------------------------------
+// the integer conversions against exact arithmetic, and the
+// float versions against them. the integer ones hit the nearest
+// bus cycle every time. the float ones agree exactly up to 2^22
+// cycles (about 87 ms). above that, a float has half a cycle or
+// less to spare, and us * 1e-6f is rarely exact to begin with, so
+// they land one off either way: the tally for this sweep is
+// pinned, as are its first cases each way. of the frequencies,
+// only the 15 listed here come out one cycle longer. whole
+// seconds all do: the result is over 2^24, where a float can't
+// hold the value one below it, so the "- 1" in period() is lost
+// ------------------------------------------------------------
+static const uint32_t floatHz[] = { 9, 11, 14, 17, 33, 51, 99, 153, 561, 1663, 1683, 21085, 22765, 57041, 57727 };
+
+static int32_t floatPeriod(float period) {
+  uint32_t exact = PITimer0.value();
+  PITimer0.period(period);
+  return int32_t(PITimer0.value() - exact);
+}
+
+static int32_t floatFrequency(float frequency) {
+  uint32_t exact = PITimer0.value();
+  PITimer0.frequency(frequency);
+  return int32_t(PITimer0.value() - exact);
+}
+
+static void checkSweeps() {
+  uint32_t longer = 0;
+  uint32_t shorter = 0;
+  for (uint32_t us = 14; us <= 340000; us += 7) {
+    PITimer0.periodMicros(us);
+    uint32_t exact = PITimer0.value();
+    CHECK(exact == us * (F_BUS / 1000000) - 1);
+    PITimer0.periodNanos(us * 1000ull);
+    CHECK(PITimer0.value() == exact);
+    int32_t off = floatPeriod(us * 1e-6f);
+    if (exact < (1u << 22)) CHECK(off == 0);
+    else CHECK(off >= -1 && off <= 1);
+    if (off > 0 && !longer++) CHECK(us == 125097);
+    if (off < 0 && !shorter++) CHECK(us == 250026);
+  }
+  CHECK(longer == 2500 && shorter == 2257);
+  const uint32_t* listed = floatHz;
+  for (uint32_t hz = 3; hz <= 75000; hz++) {
+    PITimer0.frequencyMillihertz(hz * 1000);
+    CHECK(PITimer0.value() == (F_BUS + hz / 2) / hz - 1);
+    bool isListed = listed < floatHz + sizeof(floatHz) / sizeof(floatHz[0]) && *listed == hz;
+    CHECK(floatFrequency(float(hz)) == (isListed ? 1 : 0));
+    if (isListed) listed++;
+  }
+  for (uint32_t s = 1; s <= 89; s++) {
+    PITimer0.periodMicros(s * 1000000);
+    CHECK(PITimer0.value() == s * F_BUS - 1);
+    CHECK(floatPeriod(float(s)) == 1);
+  }
+  PITimer0.periodNanos(100001);
+  CHECK(PITimer0.value() == 4799);
+  CHECK(PITimer0.periodNanos() == 100000);
+  PITimer0.frequencyMillihertz(44100000);
+  CHECK(PITimer0.value() == 1087);
+  CHECK(PITimer0.frequencyMillihertz() == 44117647);
+}
+
+
+
+int main() {
+  PITimerTest::begin();
+  checkRanges();
+  checkSweeps();
+  return PITimerTest::finish("Math");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,107 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerMotion.h"
+#include <vector>
+
+
+
+// ------------------------------------------------------------
+// the stepper driver's speed profile, from the time of every
+// step. a long move ramps up, cruises at exactly the set speed,
+// and ramps down onto the target, and the ramp follows v = a t
+// closely enough that the 500th step at 1000 steps/s^2 comes
+// within 2% of 1 s. short moves, a backwards move, stop() (which
+// slows down to a halt) and halt() (which doesn't) all have to
+// leave the position where the motor actually is
+// ------------------------------------------------------------
+static std::vector<uint64_t> steps;
+static uint32_t turns;
+
+static void step() {
+  steps.push_back(PITimerSim::now());
+}
+
+static void turn() {
+  turns++;
+}
+
+static PITimerMotion motor(PITimer0, step, turn);
+
+static void settle() {
+  for (uint32_t i = 0; motor.moving() && i < 100000; i++) PITimerSim::advance(48000);
+}
+
+static uint64_t gap(size_t i) {
+  return steps[i] - steps[i - 1];
+}
+
+int main() {
+  PITimerTest::begin();
+  motor.speed(1000);
+  motor.acceleration(1000);
+  motor.moveTo(2000);
+  settle();
+  CHECK(motor.position() == 2000);
+  CHECK(steps.size() == 2000);
+  CHECK(turns == 1 && motor.forward());
+  uint64_t shortest = UINT64_MAX;
+  for (size_t i = 1; i < steps.size(); i++) if (gap(i) < shortest) shortest = gap(i);
+  CHECK(shortest == F_BUS / 1000);
+  for (size_t i = 2; i < 400; i++) CHECK(gap(i) <= gap(i - 1));
+  for (size_t i = 1700; i < 2000; i++) CHECK(gap(i) >= gap(i - 1));
+  double t500 = double(steps[499]) / F_BUS;
+  CHECK(t500 > 0.98 && t500 < 1.02);
+
+  steps.clear();
+  motor.moveTo(1900);
+  settle();
+  CHECK(motor.position() == 1900);
+  CHECK(steps.size() == 100);
+  CHECK(!motor.forward());
+
+  steps.clear();
+  motor.moveTo(0);
+  PITimerSim::advance(uint64_t(F_BUS) * 3 / 2);
+  motor.stop();
+  int32_t stopAt = motor.target();
+  settle();
+  CHECK(motor.position() == stopAt);
+  CHECK(stopAt > 0 && stopAt < 1900);
+  for (size_t i = steps.size() - 200; i < steps.size(); i++) CHECK(gap(i) >= gap(i - 1));
+
+  steps.clear();
+  motor.acceleration(0);
+  motor.speed(200000);
+  motor.move(5000);
+  settle();
+  CHECK(motor.position() == motor.target());
+  CHECK(steps.size() == 5000);
+  CHECK(gap(10) == 640);
+
+  motor.acceleration(1000);
+  motor.speed(1000);
+  motor.move(1000);
+  PITimerSim::advance(F_BUS);
+  motor.halt();
+  int32_t haltedAt = motor.position();
+  PITimerSim::advance(F_BUS);
+  CHECK(motor.position() == haltedAt);
+  CHECK(!motor.moving());
+
+  for (uint8_t i = 0; i < 3; i++) {
+    int32_t from = motor.position();
+    motor.move(1);
+    settle();
+    CHECK(motor.position() == from + 1);
+  }
+  return PITimerTest::finish("Motion");
+}
+
+
+
+// EOF
\ No newline at end of file
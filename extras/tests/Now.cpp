@@ -0,0 +1,96 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+// ------------------------------------------------------------
+// now() against the simulated clock: it has to track it to
+// within a couple of cycles and never go backwards, through a
+// change of period, a reset(), the ISR being held off (for less
+// than a period, or the PIT itself would lose one), start() on a
+// timer that's already running (which restarts the countdown),
+// and a stop and restart (while stopped, it stands still), also
+// with an expiry still pending when it's stopped
+// ------------------------------------------------------------
+static uint64_t last;
+static uint32_t wrong;
+
+static void compare(uint64_t truth) {
+  uint64_t now = PITimer0.now();
+  if (now < last || now > truth + 2 || now + 2 < truth) {
+    if (wrong++ < 5) printf("  now() %llu, should be %llu\n", (unsigned long long)now, (unsigned long long)truth);
+  }
+  last = now;
+}
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(999);
+  uint64_t start = PITimerSim::now();
+  PITimer0.start();
+  for (uint32_t i = 0; i < 20000; i++) {
+    PITimerSim::advance(1 + i * 7 % 50);
+    compare(PITimerSim::now() - start);
+    if (i == 5000) PITimer0.value(2999);
+    if (i == 9000) PITimer0.reset();
+    if (i == 12000) __disable_irq();
+    if (i == 12050) __enable_irq();
+    if (i % 3000 == 1500) PITimer0.start();
+  }
+  CHECK(wrong == 0);
+
+  PITimerSim::advance(1000);
+  uint32_t count = PITimer0.count();
+  uint64_t restarted = PITimerSim::now();
+  PITimer0.start();
+  compare(restarted - start);
+  PITimerSim::advance(2999);
+  CHECK(PITimer0.count() == count);
+  PITimerSim::advance(1);
+  CHECK(PITimer0.count() == count + 1);
+  compare(PITimerSim::now() - start);
+  CHECK(wrong == 0);
+
+  PITimer0.stop();
+  uint64_t stopped = PITimer0.now();
+  PITimerSim::advance(5000);
+  CHECK(PITimer0.now() == stopped);
+  uint64_t restart = PITimerSim::now();
+  PITimer0.start();
+  PITimerSim::advance(12345);
+  CHECK(PITimer0.now() == stopped + PITimerSim::now() - restart);
+
+  count = PITimer0.count();
+  restart = PITimerSim::now() - PITimer0.now();
+  __disable_irq();
+  PITimerSim::advance(3000);
+  CHECK(PITimer0.expired());
+  stopped = PITimer0.now();
+  CHECK(stopped == PITimerSim::now() - restart);
+  PITimer0.stop();
+  CHECK(PITimer0.now() == stopped);
+  __enable_irq();
+  PITimerSim::advance(5000);
+  CHECK(PITimer0.now() == stopped);
+  CHECK(PITimer0.count() == count);
+  PITimer0.start();
+  PITimerSim::advance(1000);
+  CHECK(PITimer0.now() == stopped + 1000);
+  CHECK(PITimer0.count() == count);
+  PITimer0.stop();
+
+  CHECK(PITimer0.nowNanos() == PITimerNanos::time(PITimer0.now()));
+  CHECK(PITimerNanos::time(48) == 1000);
+  CHECK(PITimerNanos::time(3) == 63);
+  CHECK(PITimerNanos::time(uint64_t(F_BUS) * 3600 * 24 * 365 * 500 + 3) == 1000000000ull * 3600 * 24 * 365 * 500 + 63);
+  return PITimerTest::finish("Now");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,95 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include <vector>
+
+
+
+// ------------------------------------------------------------
+// one-shot mode and retrigger(): a one-shot fires once, a period
+// after it was started, and stops. retriggering it keeps pushing
+// the deadline out, and throws away an expiry whose ISR hasn't
+// run yet, though now() still counts the period that ended with
+// it. a callback can re-arm its own timer. start() goes back
+// to periodic mode, and retrigger() leaves that alone
+// ------------------------------------------------------------
+static std::vector<uint64_t> fired;
+static uint32_t rearms;
+
+static void record() {
+  fired.push_back(PITimerSim::now());
+}
+
+static void rearm() {
+  record();
+  if (++rearms < 3) PITimer0.retrigger();
+}
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(47999);
+  uint64_t start = PITimerSim::now();
+  PITimer0.once(record);
+  PITimerSim::advance(48000 * 5);
+  CHECK(fired.size() == 1 && fired[0] == start + 48000);
+  CHECK(!PITimer0.running());
+  CHECK(PITimer0.count() == 1);
+  uint64_t now = PITimer0.now();
+  CHECK(now == 48000);
+  PITimerSim::advance(10000);
+  CHECK(PITimer0.now() == now);
+
+  fired.clear();
+  uint64_t last = 0;
+  for (uint8_t i = 0; i < 100; i++) {
+    PITimer0.retrigger();
+    last = PITimerSim::now();
+    PITimerSim::advance(30000);
+    CHECK(PITimer0.now() >= now);
+    now = PITimer0.now();
+  }
+  CHECK(fired.empty());
+  PITimerSim::advance(48000 * 3);
+  CHECK(fired.size() == 1 && fired[0] == last + 48000);
+  CHECK(!PITimer0.running());
+
+  fired.clear();
+  PITimer0.retrigger();
+  __disable_irq();
+  PITimerSim::advance(50000);
+  CHECK(PITimer0.expired());
+  now = PITimer0.now();
+  PITimer0.retrigger();
+  last = PITimerSim::now();
+  CHECK(PITimer0.now() == now);
+  __enable_irq();
+  PITimerSim::advance(47000);
+  CHECK(fired.empty());
+  CHECK(PITimer0.now() == now + 47000);
+  PITimerSim::advance(2000);
+  CHECK(fired.size() == 1 && fired[0] == last + 48000);
+
+  fired.clear();
+  PITimer0.once(rearm);
+  PITimerSim::advance(48000 * 10);
+  CHECK(fired.size() == 3 && fired[2] - fired[0] == 96000);
+  CHECK(!PITimer0.running());
+
+  fired.clear();
+  PITimer0.start(record);
+  PITimerSim::advance(20000);
+  PITimer0.retrigger();
+  PITimerSim::advance(48000 * 3);
+  CHECK(fired.size() == 3);
+  CHECK(PITimer0.running());
+  PITimer0.stop();
+  return PITimerTest::finish("OneShot");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,60 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+// ------------------------------------------------------------
+// a callback that runs past the next expiry on every fifth call.
+// either way, each of those is one overrun, and now() keeps exact
+// time. with PITIMER_BURST every expiry still gets its call, late;
+// with PITIMER_SKIP the one that came during the long call is
+// dropped, and the handler hears about each overrun
+// ------------------------------------------------------------
+static uint32_t calls;
+static uint32_t handled;
+
+static void slowEveryFifth() {
+  if (++calls % 5 == 0) PITimerSim::advance(1500);
+}
+
+static void overran() {
+  handled++;
+}
+
+static void run(PITimerOverrun policy) {
+  PITimer0.stop();
+  PITimer0.zero();
+  calls = 0;
+  handled = 0;
+  PITimer0.overrun(policy, overran);
+  uint64_t since = PITimerSim::now();
+  uint64_t now = PITimer0.now();
+  PITimer0.start(slowEveryFifth);
+  PITimerSim::advance(100000);
+  uint64_t elapsed = PITimerSim::now() - since;
+  CHECK(PITimer0.now() - now == elapsed);
+  CHECK(PITimer0.count() == calls);
+  CHECK(PITimer0.overruns() == calls / 5);
+  CHECK(handled == calls / 5);
+  uint32_t expiries = elapsed / 1000;
+  if (policy == PITIMER_BURST) CHECK(calls == expiries);
+  else CHECK(calls == expiries - PITimer0.overruns());
+}
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(999);
+  run(PITIMER_BURST);
+  run(PITIMER_SKIP);
+  PITimer0.stop();
+  return PITimerTest::finish("Overrun");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,64 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#ifndef __PITIMERTEST_H__
+#define __PITIMERTEST_H__
+
+
+
+#include "PITimer.h"
+#include <stdint.h>
+#include <stdio.h>
+
+
+
+#ifndef PITIMER_SIM
+#error "the tests run on the simulated chip, build them with -DPITIMER_SIM"
+#endif
+
+
+
+// ------------------------------------------------------------
+// the little there is to the host-side tests in this folder.
+// each test is a program of its own, built along with the
+// library against the simulated chip (see the README). CHECK()
+// prints the first few checks that fail, with their line, and
+// finish() prints PASS or FAIL and returns the exit status, so a
+// script only has to look at that. begin() starts every test from
+// a freshly reset chip
+// ------------------------------------------------------------
+class PITimerTest {
+  private:
+    static uint32_t& failures() {
+      static uint32_t count;
+      return count;
+    }
+  public:
+    static void begin() {
+      PITimerSim::reset();
+      PITimer0.begin();
+      PITimer1.begin();
+      PITimer2.begin();
+    }
+    static void check(bool passed, const char* what, int line) {
+      if (passed) return;
+      if (failures()++ < 10) printf("  line %d: %s\n", line, what);
+    }
+    static int finish(const char* name) {
+      printf("%s: %s\n", name, failures() ? "FAIL" : "PASS");
+      return failures() ? 1 : 0;
+    }
+};
+
+#define CHECK(condition) PITimerTest::check((condition), #condition, __LINE__)
+
+
+
+#endif
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,56 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+// ------------------------------------------------------------
+// NVIC priorities and the worst-case latency worked out from the
+// ISR budgets. a timer is held up by the longest ISR it can't
+// preempt, plus every more urgent ISR that can come due in the
+// meantime. priorities only count in steps of 16 (the Teensy 3.0
+// has 4 priority bits), and a timer whose own ISR can be held up
+// past its period can't be bounded at all
+// ------------------------------------------------------------
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(2399);
+  PITimer1.value(47999999);
+  PITimer2.value(47999);
+  PITimer0.priority(64);
+  PITimer1.priority(128);
+  PITimer2.priority(128);
+  CHECK(PITimer0.priority() == 64);
+  CHECK(PITimerSim::priority(IRQ_PIT_CH0) == 64);
+  PITimer0.budget(500);
+  PITimer1.budget(100000);
+  PITimer2.budget(2000);
+  CHECK(PITimer1.budget() == 100000);
+  CHECK(PITimer0.latency() == 0);
+
+  PITimer0.start();
+  PITimer1.start();
+  PITimer2.start();
+  CHECK(PITimer0.latency() == 0);
+  CHECK(PITimer1.latency() == 2000 + 2 * 500);
+  CHECK(PITimer2.latency() == UINT32_MAX);
+  PITimer1.budget(5000);
+  CHECK(PITimer2.latency() == 5000 + 3 * 500);
+  PITimer2.priority(140);
+  CHECK(PITimer2.latency() == 5000 + 3 * 500);
+  PITimer2.priority(144);
+  CHECK(PITimer2.latency() == 5000 + 3 * 500);
+  CHECK(PITimer1.latency() == 500);
+  PITimer0.stop();
+  PITimer1.stop();
+  PITimer2.stop();
+  return PITimerTest::finish("Priority");
+}
+
+
+
+// EOF
\ No newline at end of file
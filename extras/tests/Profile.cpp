@@ -0,0 +1,65 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+#if !PITIMER_PROFILE
+#error "build this test with -DPITIMER_PROFILE=1"
+#endif
+
+
+
+// ------------------------------------------------------------
+// the ISR profiler, with a callback that takes a known time. the
+// latency is 0 when nothing holds the ISR up, and the duration is
+// the time the callback took, including a reset() inside it.
+// holding interrupts off shows up as latency
+// ------------------------------------------------------------
+static bool resets;
+
+static void work() {
+  PITimerSim::advance(100);
+  if (!resets) return;
+  PITimer0.reset();
+  PITimerSim::advance(25);
+}
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(999);
+  PITimer0.start(work);
+  PITimerSim::advance(10000);
+  PITimerProfile profile = PITimer0.profile();
+  CHECK(profile.latency.samples() == PITimer0.count());
+  CHECK(profile.latency.max() == 0);
+  CHECK(profile.duration.min() == 100 && profile.duration.max() == 100);
+  CHECK(profile.duration.mean() == 100);
+
+  PITimer0.profileZero();
+  CHECK(PITimer0.profile().duration.samples() == 0);
+  resets = true;
+  PITimerSim::advance(10000);
+  profile = PITimer0.profile();
+  CHECK(profile.duration.min() == 125 && profile.duration.max() == 125);
+
+  PITimer0.profileZero();
+  resets = false;
+  __disable_irq();
+  PITimerSim::advance(900);
+  __enable_irq();
+  PITimerSim::advance(1);
+  profile = PITimer0.profile();
+  CHECK(profile.latency.samples() == 1);
+  CHECK(profile.latency.max() > 0 && profile.latency.max() < 900);
+  PITimer0.stop();
+  return PITimerTest::finish("Profile");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,65 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+
+
+
+// ------------------------------------------------------------
+// two timers posting to one queue, drained from "loop()" in
+// batches. every event has to arrive, in order, with its timer's
+// count and an exact timestamp. a queue nobody drains fills up
+// and then drops (and counts) what doesn't fit
+// ------------------------------------------------------------
+static PITimerQueue<64> queue;
+
+int main() {
+  PITimerTest::begin();
+  PITimer0.value(999);
+  PITimer1.value(1499);
+  PITimer0.queue(&queue);
+  PITimer1.queue(&queue);
+  PITimer0.start();
+  PITimer1.start();
+  uint32_t received = 0;
+  uint32_t wrong = 0;
+  uint32_t counts[2] = { 0, 0 };
+  uint32_t stamps[2] = { 0, 0 };
+  uint32_t periods[2] = { 1000, 1500 };
+  for (uint32_t round = 0; round < 20000; round++) {
+    PITimerSim::advance(3000);
+    PITimerEvent events[16];
+    uint16_t got;
+    while ((got = queue.poll(events, 16))) {
+      for (uint16_t i = 0; i < got; i++) {
+        PITimerEvent& event = events[i];
+        received++;
+        if (event.id > 1 || event.count != counts[event.id] + 1) wrong++;
+        else if (counts[event.id] && event.timestamp - stamps[event.id] != periods[event.id]) wrong++;
+        counts[event.id & 1] = event.count;
+        stamps[event.id & 1] = event.timestamp;
+      }
+    }
+  }
+  CHECK(wrong == 0);
+  CHECK(queue.dropped() == 0);
+  CHECK(received == PITimer0.count() + PITimer1.count());
+  CHECK(counts[0] == PITimer0.count() && counts[1] == PITimer1.count());
+
+  PITimerSim::advance(1000000);
+  CHECK(queue.available() == 64);
+  CHECK(queue.dropped() > 0);
+  PITimerEvent event;
+  while (queue.poll(event)) {}
+  CHECK(queue.available() == 0);
+  PITimer0.stop();
+  PITimer1.stop();
+  return PITimerTest::finish("Queue");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,73 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerSampler.h"
+#include <vector>
+
+
+
+#if !PITIMER_SAMPLER
+#error "build this test with -DPITIMER_SAMPLER=1"
+#endif
+
+
+
+// ------------------------------------------------------------
+// the sampling profiler, with the simulated program counter
+// standing in for the sketch: 3/4 of the time at one address and
+// 1/4 at another, then a while in RAM. the counts have to come
+// out in those proportions, the dump has to hold them in its
+// documented layout, and a bucket about to overflow halves the
+// whole table instead
+// ------------------------------------------------------------
+class Sink {
+  public:
+    std::vector<uint8_t> bytes;
+    size_t write(const uint8_t* data, size_t size) {
+      bytes.insert(bytes.end(), data, data + size);
+      return size;
+    }
+};
+
+int main() {
+  PITimerTest::begin();
+  PITimerSampler::start();
+  CHECK(PITimerSampler::running());
+  for (uint32_t i = 0; i < 1000; i++) {
+    PITimerSim::pc = 0x1234;
+    PITimerSim::advance(36000);
+    PITimerSim::pc = 0x5678;
+    PITimerSim::advance(12000);
+  }
+  PITimerSim::pc = 0x1FFF8000;
+  PITimerSim::advance(48000 * 10);
+  uint32_t samples = PITimerSampler::samples();
+  CHECK(samples == 1006 || samples == 1007);
+  CHECK(PITimerSampler::count(0x12) + PITimerSampler::count(0x56) + PITimerSampler::outside() == samples);
+  CHECK(PITimerSampler::count(0x12) > 740 && PITimerSampler::count(0x12) < 755);
+  CHECK(PITimerSampler::outside() >= 9 && PITimerSampler::outside() <= 11);
+
+  Sink sink;
+  PITimerSampler::dump(sink);
+  CHECK(sink.bytes.size() == 24 + 2 * 4);
+  CHECK(sink.bytes[0] == 'P' && sink.bytes[3] == '1' && sink.bytes[4] == 8 && sink.bytes[6] == 2);
+  CHECK(sink.bytes[24] == 0x12 && sink.bytes[28] == 0x56);
+  CHECK(PITimerSampler::running());
+
+  PITimerSampler::zero();
+  PITimerSim::pc = 0x100;
+  PITimerSim::advance(uint64_t(F_BUS) * 70);
+  CHECK(PITimerSampler::scale() == 1);
+  CHECK(PITimerSampler::count(1) == PITimerSampler::samples() - 65535 + 32767);
+  PITimerSampler::stop();
+  CHECK(!PITimerSampler::running());
+  return PITimerTest::finish("Sampler");
+}
+
+
+
+// EOF
\ No newline at end of file
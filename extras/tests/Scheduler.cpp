@@ -0,0 +1,73 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerScheduler.h"
+
+
+
+// ------------------------------------------------------------
+// the multi-rate scheduler: the tick is the GCD of the task
+// periods, tasks run at their own rates with their offsets, the
+// ones in the loop only when run() is called, and a task table
+// whose periods have no usable common tick is refused with a
+// report saying why
+// ------------------------------------------------------------
+static uint32_t countA, countB, countC, countD, badB;
+static uint64_t lastB;
+
+static void taskA() { countA++; }
+static void taskC() { countC++; }
+static void taskD() { countD++; }
+
+static void taskB() {
+  uint64_t now = PITimerSim::now();
+  if (countB++ && now - lastB != 480000) badB++;
+  lastB = now;
+}
+
+static const PITimerTask tasks[] = {
+  { taskC, 100000, 0, PITIMER_IN_LOOP, 20000 },
+  { taskA, 1000, 0, PITIMER_IN_ISR, 4000 },
+  { taskB, 10000, 500, PITIMER_IN_ISR, 8000 },
+  { taskD, 10000, 500, PITIMER_IN_ISR, 0 },
+};
+
+static const PITimerTask coprime[] = {
+  { taskA, 1000, 0, PITIMER_IN_ISR, 0 },
+  { taskB, 1001, 0, PITIMER_IN_ISR, 0 },
+};
+
+PITimerScheduler<4> scheduler(PITimer0, tasks);
+PITimerScheduler<2> refused(PITimer1, coprime);
+
+int main() {
+  PITimerTest::begin();
+  CHECK(scheduler.begin());
+  const PITimerScheduleReport& report = scheduler.report();
+  CHECK(report.tick == 24000);
+  CHECK(report.hyperperiod == 200);
+  CHECK(report.rates == 3);
+  CHECK(report.feasible);
+  for (uint32_t i = 0; i < 1000; i++) {
+    PITimerSim::advance(24000);
+    if (i % 50 == 0) scheduler.run();
+  }
+  scheduler.run();
+  CHECK(countA == 500);
+  CHECK(countB == 50 && badB == 0);
+  CHECK(countC == 5);
+  CHECK(countD == 50);
+  CHECK(scheduler.ticks() == 1000);
+  CHECK(!refused.begin());
+  CHECK(!refused.report().feasible);
+  CHECK(refused.report().tick == 48);
+  return PITimerTest::finish("Scheduler");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerWheel.h"
+#include <stdlib.h>
+
+
+
+// ------------------------------------------------------------
+// timer coalescing: 40 periodic timers (1 ms and 10 ms, at random
+// phases) run for a second, first without slack and then with a
+// tenth of a period each. with slack, every timer still fires on
+// every period, within its slack (plus one shortest PIT period)
+// of its deadline, with no drift, and the PIT interrupts less
+// than a third as often
+// ------------------------------------------------------------
+static const uint8_t timerCount = 40;
+static PITimerWheel wheel(PITimer0);
+static PITimerSoft softs[timerCount];
+static uint32_t deadlines[timerCount];
+static uint32_t periods[timerCount];
+static uint32_t slacks[timerCount];
+static uint32_t fired[timerCount];
+
+static void fire(void* context) {
+  uintptr_t i = reinterpret_cast<uintptr_t>(context);
+  int32_t behind = wheel.now() - deadlines[i];
+  CHECK(behind >= 0 && behind <= int32_t(slacks[i]) + 14);
+  deadlines[i] += periods[i];
+  fired[i]++;
+}
+
+static uint32_t run(bool withSlack) {
+  PITimerTest::begin();
+  PITimer0.zero();
+  wheel.begin();
+  srand(1);
+  for (uintptr_t i = 0; i < timerCount; i++) {
+    periods[i] = i % 4 ? 1000 : 10000;
+    slacks[i] = withSlack ? periods[i] / 10 : 0;
+    softs[i].slack(slacks[i]);
+    softs[i].callback(PITimerCallback(fire, reinterpret_cast<void*>(i)));
+    uint32_t delay = 1 + uint32_t(rand()) % periods[i];
+    deadlines[i] = delay;
+    fired[i] = 0;
+    wheel.schedule(softs[i], delay, periods[i]);
+  }
+  PITimerSim::advance(uint64_t(F_BUS));
+  for (uint8_t i = 0; i < timerCount; i++) CHECK(fired[i] >= 1000000 / periods[i] - 1);
+  return PITimer0.count();
+}
+
+int main() {
+  uint32_t exact = run(false);
+  uint32_t coalesced = run(true);
+  printf("  interrupts in 1 s: %u without slack, %u with\n", exact, coalesced);
+  CHECK(coalesced < exact / 3);
+  return PITimerTest::finish("Slack");
+}
+
+
+
+// EOF
\ No newline at end of file
@@ -0,0 +1,90 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerWheel.h"
+#include <stdlib.h>
+
+
+
+// ------------------------------------------------------------
+// tickless idle: ten simulated hours of a sketch that sleeps in
+// between a 30 minute timer and a few short ones, then sleeps
+// with a millisecond already pending, then against a known
+// deadline. millis() has to be right after every single wakeup,
+// next() has to be early but never late, and the wheel's and the
+// PIT's clocks have to stay with the chip's
+// ------------------------------------------------------------
+PITimerWheel wheel(PITimer0);
+PITimerSoft slow, fast, once;
+static uint32_t slowFired, fastFired, onceFired;
+static uint32_t wrongMillis;
+
+static void onSlow() { slowFired++; }
+static void onFast() { fastFired++; }
+static void onOnce() { onceFired++; }
+
+static void checkMillis() {
+  uint64_t expected = PITimerSim::now() * (F_CPU / F_BUS) / (F_CPU / 1000);
+  if (systick_millis_count != expected) wrongMillis++;
+}
+
+int main() {
+  PITimerTest::begin();
+  SYST_RVR = F_CPU / 1000 - 1;
+  SYST_CVR = 0;
+  SYST_CSR = 7;
+  wheel.begin();
+  uint64_t start = PITimerSim::now();
+  uint64_t pitStart = PITimer0.now();
+  slow.callback(onSlow);
+  fast.callback(onFast);
+  once.callback(onOnce);
+  wheel.schedule(slow, 1800000000u, 1800000000u);
+  wheel.schedule(fast, 250000, 0);
+  srand(3);
+  uint32_t wakes = 0;
+  while (PITimerSim::now() < 48ull * 1000000 * 3600 * 10) {
+    wheel.sleep();
+    wakes++;
+    PITimerSim::advance(1 + rand() % 5000);
+    checkMillis();
+    if (fastFired && fastFired < 20 && !fast.pending()) wheel.schedule(fast, 1000 + rand() % 100000, 0);
+  }
+  CHECK(slowFired == 20);
+  CHECK(fastFired == 20);
+  CHECK(wakes < 3600 * 10 / 10);
+
+  for (uint8_t i = 0; i < 50; i++) {
+    __disable_irq();
+    PITimerSim::advance(rand() % 48000);
+    wheel.sleep();
+    __enable_irq();
+    PITimerSim::advance(1);
+    checkMillis();
+  }
+
+  wheel.schedule(once, 123456, 0);
+  uint32_t next = wheel.next();
+  CHECK(next <= 123456 && next >= 123456 - 4096);
+  while (!onceFired) {
+    wheel.sleep();
+    PITimerSim::advance(1);
+  }
+  checkMillis();
+  CHECK(wrongMillis == 0);
+
+  uint64_t elapsed = PITimerSim::now() - start;
+  uint64_t pit = PITimer0.now() - pitStart;
+  CHECK(pit <= elapsed && elapsed - pit <= 2);
+  uint32_t ticks = elapsed / 48;
+  CHECK(int32_t(wheel.now() - ticks) <= 0 && int32_t(ticks - wheel.now()) <= 1);
+  return PITimerTest::finish("Sleep");
+}
+
+
+
+// EOF
\ No newline at end of file
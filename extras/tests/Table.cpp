@@ -0,0 +1,73 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerTable.h"
+
+
+
+// ------------------------------------------------------------
+// the compile-time schedule table: every slot runs at its offset
+// in every frame, to the cycle, even when a slot's own callback
+// runs long, and a table of one slot is just a periodic timer.
+// the tables that must not compile (a slot over its budget, slots
+// out of order or too close) can be tried by defining
+// PITIMER_TEST_REJECTS to 1, 2 or 3
+// ------------------------------------------------------------
+static uint64_t fired[3][64];
+static uint32_t count[3];
+static uint64_t single[64];
+static uint32_t singles;
+
+static void slot0() { if (count[0] < 64) fired[0][count[0]++] = PITimerSim::now(); }
+static void slot2() { if (count[2] < 64) fired[2][count[2]++] = PITimerSim::now(); }
+static void only() { if (singles < 64) single[singles++] = PITimerSim::now(); }
+
+static void slot1() {
+  if (count[1] < 64) fired[1][count[1]++] = PITimerSim::now();
+  PITimerSim::advance(3000);
+}
+
+typedef PITimerTable<48000, PITimerSlot<0, slot0, 4000>, PITimerSlot<12000, slot1, 12000>, PITimerSlot<30000, slot2> > Frame;
+typedef PITimerTable<2400, PITimerSlot<100, only> > Single;
+
+#if PITIMER_TEST_REJECTS == 1
+typedef PITimerTable<48000, PITimerSlot<0, slot0, 20000>, PITimerSlot<12000, slot1> > Rejected;
+#elif PITIMER_TEST_REJECTS == 2
+typedef PITimerTable<48000, PITimerSlot<0, slot0>, PITimerSlot<100, slot1> > Rejected;
+#elif PITIMER_TEST_REJECTS == 3
+typedef PITimerTable<48000, PITimerSlot<5000, slot0>, PITimerSlot<1000, slot1> > Rejected;
+#endif
+#ifdef PITIMER_TEST_REJECTS
+void rejected() { Rejected::start(PITimer0); }
+#endif
+
+int main() {
+  PITimerTest::begin();
+  Frame::start(PITimer0);
+  PITimerSim::advance(48000 * 20 + 100);
+  CHECK(fired[0][0] == 18000);
+  for (uint32_t k = 0; k < 20; k++) {
+    CHECK(fired[0][k] == 18000 + 48000ull * k);
+    CHECK(fired[1][k] == 18000 + 12000 + 48000ull * k);
+    CHECK(fired[2][k] == 18000 + 30000 + 48000ull * k);
+  }
+  CHECK(PITimer0.now() == PITimerSim::now());
+  Frame::stop();
+
+  Single::start(PITimer1);
+  uint64_t start = PITimerSim::now();
+  PITimerSim::advance(2400 * 10);
+  CHECK(singles == 10);
+  CHECK(single[0] - start == 2400);
+  CHECK(single[9] - single[8] == 2400);
+  Single::stop();
+  return PITimerTest::finish("Table");
+}
+
+
+
+// EOF
\ No newline at end of file
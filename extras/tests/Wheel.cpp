@@ -0,0 +1,131 @@
+// Daniel Gilbert
+// loglow@gmail.com
+// copyright 2013
+
+
+
+#include "PITimerTest.h"
+#include "PITimerWheel.h"
+#include <stdlib.h>
+
+
+
+// ------------------------------------------------------------
+// the software timer wheel under load: 100,000 one-shot timers
+// with random delays up to 1.6 s (so every level of the wheel is
+// used), a share of them cancelled before they're due, some of
+// them rescheduled or cancelling a neighbour from inside their own
+// callback, and a set of periodic ones. every timer that fires
+// has to fire within one shortest PIT period (14 ticks of 1 us)
+// after its deadline, and every one that wasn't cancelled has to
+// fire exactly once per deadline. then a handful of callbacks that
+// take longer than the interval the PIT was set to (one of them
+// for hundreds of intervals): whatever came due meanwhile fires as
+// soon as they return, and neither the wheel's clock nor the
+// channel's now() loses any of the time they took
+// ------------------------------------------------------------
+static const uint32_t timerCount = 100000;
+static const uint32_t periodicCount = 100;
+
+static PITimerWheel wheel(PITimer0);
+static PITimerSoft softs[timerCount];
+static uint32_t deadlines[timerCount];
+static uint32_t periods[timerCount];
+static uint32_t fired[timerCount];
+static bool cancelled[timerCount];
+static uint32_t late;
+
+static void fire(void* context) {
+  uint32_t i = static_cast<PITimerSoft*>(context) - softs;
+  int32_t behind = uint32_t(PITimerSim::now() / 48) - deadlines[i];
+  if (cancelled[i] || behind < 0 || behind > 14) {
+    if (late++ < 5) printf("  timer %u fired %d ticks after its deadline\n", i, behind);
+  }
+  fired[i]++;
+  deadlines[i] += periods[i];
+  if (periods[i]) return;
+  if (i % 7 == 0 && fired[i] < 3) {
+    deadlines[i] = wheel.now() + 500;
+    wheel.schedule(softs[i], 500);
+  }
+  if (i % 11 == 0 && i + 1 < timerCount && !fired[i + 1] && softs[i + 1].pending()) {
+    wheel.cancel(softs[i + 1]);
+    cancelled[i + 1] = true;
+  }
+}
+
+static PITimerSoft slowSofts[6];
+static uint64_t slowFired[6];
+static uint64_t slowStart;
+
+static void slow(void* context) {
+  uint32_t i = static_cast<PITimerSoft*>(context) - slowSofts;
+  slowFired[i] = PITimerSim::now() - slowStart;
+  if (i == 0) PITimerSim::advance(2000);
+  if (i == 2) PITimerSim::advance(48 * 500);
+  if (i == 5) PITimerSim::advance(700);
+}
+
+static void longCallbacks() {
+  PITimerTest::begin();
+  uint64_t pitStart = PITimer0.now();
+  slowStart = PITimerSim::now();
+  wheel.begin();
+  static const uint32_t delays[] = { 100, 200, 300, 310, 320, 1000 };
+  for (uint8_t i = 0; i < 6; i++) {
+    slowSofts[i].callback(PITimerCallback(slow, &slowSofts[i]));
+    wheel.schedule(slowSofts[i], delays[i], i == 5 ? 20 : 0);
+  }
+  PITimerSim::advance(48 * 2000);
+  for (uint8_t i = 0; i < 5; i++) CHECK(slowFired[i] >= 48 * delays[i]);
+  CHECK(slowFired[0] <= 48 * 100 + 14 * 48);
+  CHECK(slowFired[1] <= 48 * 200 + 14 * 48);
+  CHECK(slowFired[2] <= 48 * 300 + 14 * 48);
+  CHECK(slowFired[3] >= slowFired[2] + 48 * 500 && slowFired[3] <= slowFired[2] + 48 * 500 + 14 * 48);
+  CHECK(slowFired[4] >= slowFired[2] + 48 * 500 && slowFired[4] <= slowFired[2] + 48 * 500 + 14 * 48);
+  uint64_t elapsed = PITimerSim::now() - slowStart;
+  CHECK(PITimer0.now() - pitStart == elapsed);
+  CHECK(int32_t(wheel.now() - uint32_t(elapsed / 48)) <= 0 && int32_t(uint32_t(elapsed / 48) - wheel.now()) <= 1);
+  wheel.end();
+}
+
+int main() {
+  PITimerTest::begin();
+  wheel.begin();
+  srand(1);
+  for (uint32_t i = 0; i < timerCount; i++) {
+    softs[i].callback(PITimerCallback(fire, &softs[i]));
+    uint32_t delay = uint32_t(rand()) % 1600000 + 1;
+    periods[i] = i < periodicCount ? uint32_t(rand()) % 3000 + 50 : 0;
+    deadlines[i] = wheel.now() + delay;
+    wheel.schedule(softs[i], delay, periods[i]);
+    if (i % 2) PITimerSim::advance(rand() % 20);
+  }
+  for (uint32_t i = periodicCount; i < timerCount; i += 3) {
+    if (fired[i] || !softs[i].pending()) continue;
+    wheel.cancel(softs[i]);
+    cancelled[i] = true;
+  }
+  uint32_t start = wheel.now();
+  PITimerSim::advance(48ull * 1700000);
+  CHECK(late == 0);
+  uint32_t missing = 0;
+  for (uint32_t i = periodicCount; i < timerCount; i++) {
+    uint32_t expected = cancelled[i] ? 0 : i % 7 == 0 ? 3 : 1;
+    if (fired[i] != expected && missing++ < 5) printf("  timer %u fired %u times\n", i, fired[i]);
+  }
+  CHECK(missing == 0);
+  for (uint32_t i = 0; i < periodicCount; i++) {
+    CHECK(int32_t(deadlines[i] - wheel.now()) > -15);
+    CHECK(softs[i].pending());
+  }
+  CHECK(wheel.now() - start == uint32_t(PITimerSim::now() / 48) - start);
+  for (uint32_t i = 0; i < periodicCount; i++) wheel.cancel(softs[i]);
+  CHECK(wheel.next() == UINT32_MAX);
+  longCallbacks();
+  return PITimerTest::finish("Wheel");
+}
+
+
+
+// EOF
\ No newline at end of file